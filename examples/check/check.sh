@@ -0,0 +1,182 @@
+#!/bin/bash
+#
+# Check noclock on the examples (see `make check`):
+#
+# - the output of each example matches expected/<example>.x10, and for each
+#   pass with an expected/<example>.<pass>.x10 file, the output of that pass;
+# - each pass keeps the calls of the final program: run by `--run final` with
+#   the kernels of kernels.c, it makes the same calls with and without the
+#   pass;
+# - CHECK_REPEAT runs in the same process, with and without every pass, raise
+#   no sanitizer report, leak nothing, and do not raise the peak memory of a
+#   single run by more than CHECK_GROWTH percent.
+#
+# Every parameter is given the value CHECK_VALUE, so that --specialize and
+# --unroll have constant loops to work on.
+#
+# With CHECK_UPDATE=1, the expected outputs are written instead of compared.
+#
+# Usage:
+#     check.sh <noclock> <sanitized noclock> <kernels> <example>...
+
+NOCLOCK=$1
+SANITIZED=$2
+KERNELS=$3
+shift 3
+
+CHECK_REPEAT=${CHECK_REPEAT:-1000}
+CHECK_VALUE=${CHECK_VALUE:-4}
+CHECK_GROWTH=${CHECK_GROWTH:-10}
+CHECK_UPDATE=${CHECK_UPDATE:-0}
+
+EXPECTED=$(dirname "$0")/expected
+
+export ASAN_OPTIONS=detect_leaks=1:halt_on_error=1
+export UBSAN_OPTIONS=halt_on_error=1:print_stacktrace=1
+
+################################################################################
+# Passes
+################################################################################
+
+# One pass per line: its name, then its options.
+passes ()
+{
+    cat << EOF
+no-fast-path --no-fast-path
+no-date-compression --no-date-compression
+no-peephole --no-peephole
+wavefront --wavefront
+tile --tile 2
+async-chunk --async-chunk 4
+spawn-tree --spawn-tree 2
+time-block --time-block auto
+hoist --hoist
+strength-reduce --strength-reduce
+unswitch --unswitch 16
+auto --auto
+specialize --specialize
+unroll --specialize --unroll 4
+dispatch --dispatch N>=M>=1
+EOF
+}
+
+# The options of every pass at once.
+all_passes ()
+{
+    passes | while read name options; do
+        echo -n "$options "
+    done
+}
+
+################################################################################
+# Helpers
+################################################################################
+
+failures=0
+
+fail ()
+{
+    echo -e "  \x1B[1mFAILED\x1B[0m $*"
+    failures=$((failures + 1))
+}
+
+# -D <parameter>=CHECK_VALUE for each parameter of an example.
+defines ()
+{
+    sed -n 's/^ *Program *\[\(.*\)\].*/\1/p' "$1" | tr ',' '\n' \
+        | sed 's/ //g; /^$/d; s/.*/-D &='"$CHECK_VALUE"'/' | tr '\n' ' '
+}
+
+# Compare (or write) the output of an example against an expected file.
+check_output ()
+{
+    local example=$1 expected=$2
+    shift 2
+
+    local output
+    output=$("$NOCLOCK" --no-colours $(defines "$example") "$@" "$example" \
+        2> /dev/null)
+    if [ $? -ne 0 ]; then
+        fail "$example $*: noclock failed"
+    elif [ "$CHECK_UPDATE" = 1 ]; then
+        echo "$output" > "$expected"
+    elif ! diff -u "$expected" - <<< "$output"; then
+        fail "$example $*: output differs from $expected"
+    fi
+}
+
+# The calls made by the final program of an example.
+calls ()
+{
+    local example=$1
+    shift
+
+    "$NOCLOCK" --no-colours --run final --kernels "$KERNELS" \
+        $(defines "$example") "$@" "$example" 2>&1 > /dev/null \
+        | grep "^checksum"
+}
+
+# The peak memory (in kB) of the runs of an example.
+peak_memory ()
+{
+    local example=$1
+    shift
+
+    "$NOCLOCK" --no-colours --verbose $(defines "$example") "$@" "$example" \
+        2>&1 > /dev/null | sed -n 's/.*Peak resident set size: \([0-9]*\) kB/\1/p'
+}
+
+################################################################################
+# Checks
+################################################################################
+
+for example in "$@"; do
+    name=$(basename "$example" .x10p2)
+    echo "  $example"
+
+    # Outputs.
+    check_output "$example" "$EXPECTED/$name.x10"
+    while read pass options; do
+        if [ -f "$EXPECTED/$name.$pass.x10" ]; then
+            check_output "$example" "$EXPECTED/$name.$pass.x10" $options
+        fi
+    done < <(passes)
+
+    # Calls.
+    reference=$(calls "$example")
+    if [ -z "$reference" ]; then
+        fail "$example: --run final failed"
+    else
+        while read pass options; do
+            result=$(calls "$example" $options)
+            if [ "$result" != "$reference" ]; then
+                fail "$example $options: $result instead of $reference"
+            fi
+        done < <(passes)
+    fi
+
+    for options in "" "$(all_passes)"; do
+        # Sanitizers and leaks.
+        log=$("$SANITIZED" --no-colours --repeat "$CHECK_REPEAT" \
+            $(defines "$example") $options "$example" 2>&1 > /dev/null)
+        if [ $? -ne 0 ] || grep -q "Sanitizer\|runtime error" <<< "$log"; then
+            echo "$log"
+            fail "$example $options: sanitized runs failed"
+        fi
+
+        # Memory.
+        single=$(peak_memory "$example" --repeat 1 $options)
+        repeated=$(peak_memory "$example" --repeat "$CHECK_REPEAT" $options)
+        if [ -z "$single" ] || [ -z "$repeated" ] \
+            || [ $((repeated * 100)) -gt $((single * (100 + CHECK_GROWTH))) ]
+        then
+            fail "$example $options: peak memory of $repeated kB after" \
+                "$CHECK_REPEAT runs, $single kB after one"
+        fi
+    done
+done
+
+if [ $failures -ne 0 ]; then
+    echo -e "\x1B[1m$failures checks failed.\x1B[0m"
+    exit 1
+fi
@@ -0,0 +1,84 @@
+/**
+ * \file kernels.c
+ * \brief Kernels of the examples for `noclock --run`, which sum up the calls.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ *
+ * Each call adds a hash of its function and arguments to a checksum, which
+ * does not depend on the order of the calls. Two programs which make the same
+ * calls, in any order, get the same checksum.
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Checksum.
+////////////////////////////////////////////////////////////////////////////////
+
+static atomic_ulong _calls;
+static atomic_ulong _checksum;
+
+static void _call (unsigned long int function, const long * arguments,
+        int count)
+{
+    unsigned long int hash = 14695981039346656037UL ^ function;
+    for (int a = 0; a < count; ++a)
+        hash = (hash ^ (unsigned long int) arguments[a]) * 1099511628211UL;
+
+    atomic_fetch_add (& _calls, 1);
+    atomic_fetch_add (& _checksum, hash);
+}
+
+/* Printed once the interpreter is done with the kernels. */
+__attribute__ ((destructor)) static void _report (void)
+{
+    fprintf (stderr, "checksum        %lu calls, %016lx\n",
+            atomic_load (& _calls), atomic_load (& _checksum));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels.
+////////////////////////////////////////////////////////////////////////////////
+
+#define KERNEL(n) \
+    void S##n (long * arguments, int count) \
+    { \
+        _call (n, arguments, count); \
+    }
+
+KERNEL (0)
+KERNEL (1)
+KERNEL (2)
+KERNEL (3)
+KERNEL (4)
+KERNEL (5)
+KERNEL (6)
+KERNEL (7)
+KERNEL (8)
+KERNEL (9)
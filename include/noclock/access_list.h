@@ -0,0 +1,174 @@
+/**
+ * \file access_list.h
+ * \brief Array accesses of function calls.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __ACCESS_LIST_H__
+#define __ACCESS_LIST_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <sysexits.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/pretty_print.h"
+#include "noclock/expression.h"
+#include "noclock/expression_list.h"
+
+/**
+ * \defgroup access_list_group Lists of array accesses
+ * \brief Array accesses annotated on function calls.
+ * \since version `1.1.0`
+ *
+ * The calls of the input programs may list the array elements they read
+ * and write:
+ *
+ * ~~~
+ * S0 (i, j) reads A[i][j - 1], B[j] writes A[i][j];
+ * ~~~
+ *
+ * Each node of an ::access_list is a single access.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Array access list.
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ */
+typedef struct access_list
+{
+    char * array;                   /**< The accessed array. */
+    expression_list * indices;      /**< The indices, one per dimension. */
+    bool write;                     /**< Whether the access is a write. */
+    struct access_list * next;      /**< The next access. */
+} access_list;
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation, initialization, copy, cleaning, free.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Allocate an access.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * \param array The accessed array.
+ * \param indices The indices.
+ * \return The newly allocated node.
+ */
+access_list * access_list_alloc (char * array, expression_list * indices);
+
+/**
+ * \brief Free an access list.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * \param list The list.
+ */
+void access_list_free (access_list * list);
+
+/**
+ * \brief Copy an access list.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * \param list The list.
+ * \return The copy.
+ */
+access_list * access_list_copy (const access_list * list);
+
+////////////////////////////////////////////////////////////////////////////////
+// Operations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Concatenate two access lists.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * \param a First list.
+ * \param b Second list.
+ * \return The resulting list.
+ */
+access_list * access_list_cat (access_list * a, access_list * b);
+
+/**
+ * \brief Mark the accesses of a list as reads or writes.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * \param list The list (modified).
+ * \param write Whether the accesses are writes.
+ * \return The list.
+ */
+access_list * access_list_set_write (access_list * list, bool write);
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print the accesses of a list as in the input programs.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * \param f Output file.
+ * \param list The list.
+ */
+void access_list_fprint (FILE * f, const access_list * list);
+
+/**
+ * \brief Convert an access to the ISL notation.
+ * \relates access_list
+ * \ingroup access_list_group
+ * \since version `1.1.0`
+ *
+ * Only the node itself is converted: `A[i][j - 1]` becomes
+ * `A[i, (j - 1)]`.
+ *
+ * \param list The node.
+ * \return The string (to be freed).
+ */
+char * access_list_to_string (const access_list * list);
+
+#endif /* __ACCESS_LIST_H__ */
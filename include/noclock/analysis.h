@@ -0,0 +1,171 @@
+/**
+ * \file analysis.h
+ * \brief Work and parallelism of NoClock programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __ANALYSIS_H__
+#define __ANALYSIS_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <isl/ctx.h>
+#include <isl/set.h>
+#include <isl/map.h>
+#include <isl/union_set.h>
+#include <isl/union_map.h>
+#include <isl/point.h>
+#include <isl/val.h>
+#include <isl/polynomial.h>
+
+#ifdef NOCLOCK_BARVINOK
+    #include <barvinok/isl.h>
+#endif
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/instruction_to_set.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup analysis_group Work and parallelism.
+ * \brief Count the instances of NoClock programs.
+ * \since version `1.1.0`
+ *
+ * The instances of the calls, asyncs and finishes of a program are gathered
+ * into ISL sets, the iterators of the enclosing loops being their
+ * dimensions. The *phase* of a call is:
+ *
+ * - its clock date within its top-level instruction, for input programs
+ *   (see program_to_set_list()).
+ * - the innermost finish around it outside of any async, for final
+ *   programs: the calls of a phase run in parallel, the phases run one after
+ *   the other. Calls outside of any finish are phases of their own, unless
+ *   they are within asyncs.
+ *
+ * The sets are then counted for given values of the parameters. When built
+ * with barvinok (`make BARVINOK=1`), they are also counted symbolically, as
+ * piecewise quasi-polynomials of the parameters.
+ *
+ * Loop boundaries and conditions must be affine, with divisions by
+ * constants, minimums and maximums: programs with assignments, such as those
+ * of instruction_list_reduce_strength(), cannot be analyzed.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Instances of a program.
+ * \ingroup analysis_group
+ * \since version `1.1.0`
+ */
+typedef struct analysis
+{
+    isl_ctx * ctx;                      /**< ISL context of the sets. */
+    const string_list * parameters;     /**< Parameters of the program. */
+    bool affine;                        /**< Whether the sets are exact. */
+    size_t statements;                  /**< Number of named statements. */
+    isl_union_set * calls;              /**< Instances of the calls. */
+    isl_union_map * phases;             /**< Phase of each call instance. */
+    isl_union_set * asyncs;             /**< Instances of the asyncs. */
+    isl_union_set * finishes;           /**< Instances of the finishes. */
+} analysis;
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation, initialization, copy, cleaning, free.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Initialize an analysis.
+ * \relates analysis
+ * \ingroup analysis_group
+ * \since version `1.1.0`
+ *
+ * \param a Analysis.
+ * \param parameters Parameters of the program, which must outlive it.
+ */
+void analysis_init (analysis * a, const string_list * parameters);
+
+/**
+ * \brief Clean an analysis.
+ * \relates analysis
+ * \ingroup analysis_group
+ * \since version `1.1.0`
+ *
+ * \param a Analysis.
+ */
+void analysis_clean (analysis * a);
+
+////////////////////////////////////////////////////////////////////////////////
+// Analysis.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Gather the instances of a program.
+ * \relates analysis
+ * \ingroup analysis_group
+ * \since version `1.1.0`
+ *
+ * \param a Analysis (see analysis_init()).
+ * \param list The program.
+ * \param dates Whether the phases are the clock dates of an input program,
+ *              rather than the finishes of a final program.
+ */
+void instruction_list_analyze (analysis * a, const instruction_list * list,
+        bool dates);
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print the work, phases, asyncs and finishes of a program.
+ * \relates analysis
+ * \ingroup analysis_group
+ * \since version `1.1.0`
+ *
+ * Each line holds the symbolic count, when built with barvinok, then the
+ * count for the given values. The average number of instances per phase is
+ * only given for values.
+ *
+ * \param f Output file.
+ * \param a Analysis.
+ * \param values Values of the parameters, in order, or `NULL`.
+ */
+void analysis_fprint (FILE * f, const analysis * a, const long int * values);
+
+#endif /* __ANALYSIS_H__ */
@@ -0,0 +1,106 @@
+/**
+ * \file async_chunk.h
+ * \brief Async granularity control.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ASYNC_CHUNK_H__
+#define __ASYNC_CHUNK_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/cost.h"
+
+/**
+ * \defgroup async_chunk_group Async granularity.
+ * \brief Spawn one async per chunk of iterations.
+ * \since version `1.1.0`
+ *
+ * A loop whose body is a single async spawns one activity per iteration:
+ *
+ * ~~~
+ * for i in (lo..hi)
+ *     async
+ *         X
+ * ~~~
+ *
+ * It is strip-mined so that each activity runs a chunk of consecutive
+ * iterations serially:
+ *
+ * ~~~
+ * for i_chunk in (0..((hi - lo) / K))
+ *     async
+ *         for i in ((lo + (K * i_chunk))..min (hi, ((lo + (K * i_chunk)) + (K - 1))))
+ *             X
+ * ~~~
+ *
+ * The iterations of a chunk were independent activities within the same
+ * finish: running them in sequence keeps every ordering the program had.
+ *
+ * When a profile gives the time of every statement of the async, the chunks
+ * are sized so that their work amortizes their spawn (see cost_grain()), yet
+ * still give every worker a chunk. A loop whose whole work would not
+ * amortize a single spawn runs within its parent activity instead:
+ *
+ * ~~~
+ * for i in (lo..hi)
+ *     X
+ * ~~~
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Strip-mine the loops spawning one async per iteration.
+ * \ingroup async_chunk_group
+ * \since version `1.1.0`
+ *
+ * With a chunk size of `0`, each loop is cut into \p workers chunks of
+ * (nearly) equal sizes, unless its trip count is known and does not exceed
+ * \p workers. The loops whose statements are all profiled ignore \p chunk.
+ *
+ * \param list Input AST (modified).
+ * \param chunk Number of iterations per async, or `0` for \p workers chunks.
+ * \param workers Number of workers.
+ * \param model What is known of the run.
+ */
+void instruction_list_chunk_asyncs (instruction_list * list,
+        unsigned long int chunk, unsigned long int workers,
+        const cost_model * model);
+
+#endif /* __ASYNC_CHUNK_H__ */
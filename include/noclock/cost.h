@@ -0,0 +1,193 @@
+/**
+ * \file cost.h
+ * \brief Cost model of clocked and clock-free programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __COST_H__
+#define __COST_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/string_list.h"
+#include "noclock/profile.h"
+
+/**
+ * \defgroup cost_group Cost model.
+ * \brief Estimate what a program costs beyond its calls.
+ * \since version `1.1.0`
+ *
+ * Removing the clocks is not always a win: ISL may generate long guarded
+ * code, and a finish per phase may cost more than the barriers it replaces.
+ * The cost of a program is estimated from:
+ *
+ * - its size: the number of instructions and expression nodes.
+ * - its spawns: the number of activities spawned by async blocks.
+ * - its threads: the number of clocked activities, which run on threads of
+ *   their own so that they can wait at barriers.
+ * - its joins: the number of finish blocks waited for.
+ * - its barriers: the number of times an activity reaches an advance.
+ * - its work: the time of its calls, when a profile gives them.
+ *
+ * Each instruction runs once per iteration of its enclosing loops. Loops run
+ * for the number of iterations given by their boundaries when the values of
+ * the parameters are known, and for an arbitrary number of iterations
+ * otherwise. Each branch of a condition runs half of the time.
+ *
+ * The total weighs each count by its rough cost in tens of nanoseconds: a
+ * thread costs a hundred spawns, and reaching an advance costs about as much
+ * as a spawn. Keeping the clocks thus pays off for long-lived activities
+ * whose phases would each spawn several asyncs once the clocks are removed.
+ * The same weights tell the passes which choose the granularity of asyncs
+ * and phases how much work amortizes a spawn or a join.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief What is known of a run of a program.
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ */
+typedef struct cost_model
+{
+    const string_list * names;      /**< Parameters whose values are known. */
+    const long int * values;        /**< Their values, in the same order. */
+    const profile * profile;        /**< Times of the statements, or `NULL`. */
+} cost_model;
+
+/**
+ * \brief Estimated cost of a program.
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ */
+typedef struct cost
+{
+    double size;        /**< Instructions and expression nodes. */
+    double spawns;      /**< Activities spawned. */
+    double threads;     /**< Clocked activities spawned. */
+    double joins;       /**< Finishes waited for. */
+    double barriers;    /**< Advances reached. */
+    double work;        /**< Nanoseconds spent in profiled calls. */
+    unsigned long int unprofiled; /**< Call sites missing from the profile. */
+} cost;
+
+////////////////////////////////////////////////////////////////////////////////
+// Estimation.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Estimate the cost of a program.
+ * \relates cost
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ *
+ * \param list The program.
+ * \param model What is known of the run.
+ * \param c Estimated cost.
+ */
+void instruction_list_cost (const instruction_list * list,
+        const cost_model * model, cost * c);
+
+/**
+ * \brief Count the iterations of a loop.
+ * \relates cost_model
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ *
+ * \param model What is known of the run.
+ * \param loop The loop.
+ * \param iterations Its number of iterations.
+ * \retval true if its boundaries are known.
+ */
+bool cost_model_iterations (const cost_model * model,
+        const instruction * loop, long int * iterations);
+
+/**
+ * \brief Weigh the counts of a cost.
+ * \relates cost
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ *
+ * \param c Cost.
+ * \return The total.
+ */
+double cost_total (const cost * c);
+
+/**
+ * \brief Whether the work of a cost is known.
+ * \relates cost
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ *
+ * \param c Cost.
+ * \retval true if every call was profiled, and there was at least one.
+ */
+bool cost_is_profiled (const cost * c);
+
+/**
+ * \brief Number of runs of instructions which amortize an overhead.
+ * \relates cost
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ *
+ * Spawning an async or waiting for a finish is amortized once the work it
+ * covers costs about a hundred spawns (10 microseconds).
+ *
+ * \param c Cost of a single run of the instructions.
+ * \return The number of runs, at least `1`.
+ */
+unsigned long int cost_grain (const cost * c);
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print a cost.
+ * \relates cost
+ * \ingroup cost_group
+ * \since version `1.1.0`
+ *
+ * \param f Output file.
+ * \param c Cost.
+ */
+void cost_fprint (FILE * f, const cost * c);
+
+#endif /* __COST_H__ */
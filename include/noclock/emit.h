@@ -0,0 +1,180 @@
+/**
+ * \file emit.h
+ * \brief Code generation back ends.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __EMIT_H__
+#define __EMIT_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/pretty_print.h"
+#include "noclock/expression.h"
+#include "noclock/expression_list.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup emit_group Code generation back ends.
+ * \brief Print the final program in other languages than X10.
+ * \since version `1.1.0`
+ *
+ * The C back end with OpenMP tasks maps:
+ *
+ * NoClock                  | C
+ * ------------------------ | -----------------------------------------------
+ * `for i in (lo..hi)`      | `for (long i = lo; i <= hi; ++i)`
+ * `async`                  | `#pragma omp task`
+ * `finish`                 | `#pragma omp taskgroup`
+ * `val x = e`, `var x = e` | `const long x = e;`, `long x = e;`
+ * `S (a, b)`               | `S (a, b);`, with `extern void S (long, long);`
+ *
+ * The program runs within the `single` construct of a parallel region, so
+ * that its tasks are spread among the threads of the team. The locals are
+ * `firstprivate` within tasks by default, which is what asyncs capture.
+ * Divisions round towards negative infinity, as in the ISL ASTs.
+ *
+ * The C++ back end runs the activities as C++20 coroutines on the
+ * work-stealing runtime of the `runtime` directory, which spawns them for a
+ * few nanoseconds:
+ *
+ * NoClock                  | C++
+ * ------------------------ | -----------------------------------------------
+ * `async`                  | `fK.spawn ([] (noclock::finish & fK, long i, ...) -> noclock::task { ... } (fK, i, ...));`
+ * `finish`                 | `{ noclock::finish fK; ... co_await fK; }`
+ *
+ * where `fK` is the innermost finish and the locals are passed by value.
+ * The functions called by the program keep the C linkage.
+ *
+ * The SPMD back end prints the input program instead, clocks included, as
+ * C with POSIX threads: it is the baseline the clock-free programs compete
+ * with. Each async runs on a thread of its own, which registers on the clock
+ * of the innermost clocked finish when the async is clocked:
+ *
+ * NoClock                  | SPMD C
+ * ------------------------ | -----------------------------------------------
+ * `clocked finish`         | a clock and a finish, the body being registered on the clock until it ends
+ * `clocked async`          | `noclock_spawn` of a function taking the locals, registered on the clock
+ * `advance`                | `noclock_clock_advance`: a barrier among the registered activities
+ *
+ * In every case, a driver reads the parameters of the program from the
+ * command line:
+ *
+ * ~~~
+ * ./a.out <N> <M>
+ * ~~~
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Output formats.
+ * \ingroup emit_group
+ * \since version `1.1.0`
+ */
+typedef enum emit_format
+{
+    EMIT_X10,               /**< X10, as NoClock prints it. */
+    EMIT_C_OPENMP,          /**< C with OpenMP tasks. */
+    EMIT_CPP_CORO,          /**< C++ with coroutines. */
+    EMIT_C_SPMD,            /**< C with threads and barriers, clocks kept. */
+    EMIT_UNKNOWN,           /**< Unknown format. */
+} emit_format;
+
+////////////////////////////////////////////////////////////////////////////////
+// Output formats.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Get the output format named by a string.
+ * \ingroup emit_group
+ * \since version `1.1.0`
+ *
+ * \param name Name of the format: `x10`, `c-openmp`, `cpp-coro` or `c-spmd`.
+ * \return The format, ::EMIT_UNKNOWN if there is no such format.
+ */
+emit_format emit_format_from_string (const char * name);
+
+////////////////////////////////////////////////////////////////////////////////
+// Back ends.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print a program as C with OpenMP tasks.
+ * \ingroup emit_group
+ * \since version `1.1.0`
+ *
+ * The functions called by the program are declared `extern`, with as many
+ * `long` arguments as their first call has.
+ *
+ * \param f Output stream.
+ * \param list The program, without clocks.
+ * \param parameters Parameters of the program.
+ */
+void instruction_list_emit_c_openmp (FILE * f, const instruction_list * list,
+        const string_list * parameters);
+
+/**
+ * \brief Print a program as C++ with coroutines.
+ * \ingroup emit_group
+ * \since version `1.1.0`
+ *
+ * The program includes `noclock_runtime.hpp` and must be linked with the
+ * runtime library.
+ *
+ * \param f Output stream.
+ * \param list The program, without clocks.
+ * \param parameters Parameters of the program.
+ */
+void instruction_list_emit_cpp_coro (FILE * f, const instruction_list * list,
+        const string_list * parameters);
+
+/**
+ * \brief Print a program with clocks as C with threads and barriers.
+ * \ingroup emit_group
+ * \since version `1.1.0`
+ *
+ * An `advance` outside of any clocked async is ignored.
+ *
+ * \param f Output stream.
+ * \param list The program, with its clocks.
+ * \param parameters Parameters of the program.
+ */
+void instruction_list_emit_c_spmd (FILE * f, const instruction_list * list,
+        const string_list * parameters);
+
+#endif /* __EMIT_H__ */
@@ -580,6 +580,32 @@ bool expression_is_true (const expression * e);
  */
 bool expression_is_false (const expression * e);
 
+/**
+ * \brief Determine whether two expressions are syntactically equal.
+ * \relates expression
+ * \ingroup expression_getter
+ * \since version `1.1.0`
+ *
+ * \param a Expression of interest.
+ * \param b Expression of interest.
+ * \retval true if the expressions are equal.
+ * \retval false otherwise.
+ */
+bool expression_equal (const expression * a, const expression * b);
+
+/**
+ * \brief Determine whether an expression refers to an identifier.
+ * \relates expression
+ * \ingroup expression_getter
+ * \since version `1.1.0`
+ *
+ * \param e Expression of interest.
+ * \param identifier Identifier.
+ * \retval true if the expression refers to the identifier.
+ * \retval false otherwise.
+ */
+bool expression_uses (const expression * e, const char * identifier);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Operations.
 ////////////////////////////////////////////////////////////////////////////////
@@ -836,6 +862,23 @@ expression * expression_eq (expression * a, expression * b);
  */
 expression * expression_ne (expression * a, expression * b);
 
+/**
+ * \brief Replace an identifier by an expression.
+ * \relates expression
+ * \ingroup expression_operation
+ * \since version `1.1.0`
+ *
+ * \param e Expression.
+ * \param identifier Identifier to replace.
+ * \param value Replacement.
+ * \return A new expression, where each occurrence of the identifier is a
+ * copy of the replacement.
+ *
+ * \note Unlike the other operations, neither e nor value are modified.
+ */
+expression * expression_substitute (const expression * e,
+        const char * identifier, const expression * value);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Input/Output.
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,17 +252,6 @@ expression_list * expression_list_append (expression_list * list,
  */
 expression_list * expression_list_cat (expression_list * a, expression_list * b);
 
-/**
- * \brief Strip an expression list.
- * \relates expression_list
- * \ingroup expression_list_operation
- * \since version `1.0.0`
- *
- * \param list The expression list
- * \return The resulting list.
- */
-expression_list * expression_list_strip (expression_list * list);
-
 ////////////////////////////////////////////////////////////////////////////////
 // Input/Output.
 ////////////////////////////////////////////////////////////////////////////////
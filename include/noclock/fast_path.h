@@ -0,0 +1,78 @@
+/**
+ * \file fast_path.h
+ * \brief Clock removal without ISL.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __FAST_PATH_H__
+#define __FAST_PATH_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/expression_list.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+
+/**
+ * \defgroup fast_path_group Fast path.
+ * \ingroup conversion_group
+ * \brief Remove the clocks of simple programs without ISL.
+ * \since version `1.1.0`
+ *
+ * Some programs do not need any polyhedral machinery:
+ *
+ * - programs in which clocks do not order anything (no clocked construct,
+ *   or a single clocked activity per clocked finish): the clocked
+ *   constructs become plain ones and the advances are dropped.
+ * - rectangular lockstep nests, that is a clocked finish holding a loop which
+ *   spawns a clocked async per iteration, each running a loop whose bounds
+ *   do not depend on the outer iterator and whose body is a call followed by
+ *   an advance: the date of each call is known in closed form.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Fast path.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Remove the clocks of a program without ISL.
+ * \ingroup fast_path_group
+ * \since version `1.1.0`
+ *
+ * \param program Input program.
+ * \return The program without clocks, or `NULL` if ISL is required.
+ */
+instruction_list * fast_path (const instruction_list * program);
+
+#endif /* __FAST_PATH_H__ */
@@ -0,0 +1,125 @@
+/**
+ * \file hoist.h
+ * \brief Loop-invariant hoisting and strength reduction.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __HOIST_H__
+#define __HOIST_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup hoist_group Loop-invariant hoisting and strength reduction.
+ * \brief Compute the index expressions of generated loops less often.
+ * \since version `1.1.0`
+ *
+ * The bounds and arguments rebuilt from ISL ASTs often recompute the same
+ * terms at every iteration of inner loops.
+ *
+ * Hoisting binds each subexpression which does not depend on the iterators
+ * of the loops enclosing it to a `val`, declared at the head of the
+ * outermost scope where its identifiers are bound:
+ *
+ * ~~~
+ * for c0 in (0..(N - 1))
+ *     for c3 in (0..(N - 1))
+ *         S (c3, ((-N + c0) + c3))
+ * ~~~
+ *
+ * becomes:
+ *
+ * ~~~
+ * val v0 = (N - 1);
+ * for c0 in (0..v0)
+ * {
+ *     val v1 = (-N + c0);
+ *     for c3 in (0..v0)
+ *         S (c3, (v1 + c3))
+ * }
+ * ~~~
+ *
+ * Strength reduction replaces the affine expressions of a loop iterator by a
+ * `var`, initialized before the loop and incremented by the coefficient of
+ * the iterator at the end of each iteration:
+ *
+ * ~~~
+ * for i in (lo..hi)
+ *     S (((c * i) + x))
+ * ~~~
+ *
+ * becomes:
+ *
+ * ~~~
+ * var v0 = ((c * lo) + x);
+ * for i in (lo..hi)
+ * {
+ *     S (v0);
+ *     v0 = (v0 + c);
+ * }
+ * ~~~
+ *
+ * Activities cannot capture a `var`: the occurrences within asyncs are not
+ * reduced.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Hoist the loop-invariant subexpressions into `val` bindings.
+ * \ingroup hoist_group
+ * \since version `1.1.0`
+ *
+ * \param list Input AST (modified).
+ * \return The AST, starting with the bindings hoisted to the top level.
+ */
+instruction_list * instruction_list_hoist (instruction_list * list);
+
+/**
+ * \brief Reduce the affine expressions of loop iterators to `var` updates.
+ * \ingroup hoist_group
+ * \since version `1.1.0`
+ *
+ * \param list Input AST (modified).
+ * \return The AST, starting with the variables of the top-level loops.
+ */
+instruction_list * instruction_list_reduce_strength (instruction_list * list);
+
+#endif /* __HOIST_H__ */
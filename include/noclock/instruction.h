@@ -45,6 +45,7 @@
 #include "noclock/expression.h"
 #include "noclock/expression_list.h"
 #include "noclock/string_list.h"
+#include "noclock/access_list.h"
 
 /**
  * \defgroup instruction_global_group Instructions
@@ -76,6 +77,8 @@
  * - ::INSTR_FINISH: the instruction is an `async` block.
  * - ::INSTR_CLOCKED_FINISH or ::INSTR_CLOCKED_ASYNC: the instruction is a
  *   `clocked` version of either a ::INSTR_FINISH or ::INSTR_ASYNC block.
+ * - ::INSTR_VAL, ::INSTR_VAR or ::INSTR_ASSIGN: the instruction binds a value
+ *   to an identifier. These only appear in generated programs.
  * - ::INSTR_UNKNOWN: the instruction's type is unknown.
  *
  * For further information on:
@@ -103,6 +106,9 @@ typedef enum instruction_type
     INSTR_ASYNC,            /**< The instruction is an `async` block. */
     INSTR_CLOCKED_FINISH,   /**< The instruction is a `clocked finish` block. */
     INSTR_CLOCKED_ASYNC,    /**< The instruction is a `clocked async` block. */
+    INSTR_VAL,              /**< The instruction is a `val` declaration. */
+    INSTR_VAR,              /**< The instruction is a `var` declaration. */
+    INSTR_ASSIGN,           /**< The instruction is an assignment. */
     INSTR_UNKNOWN,          /**< The instruction's type is unknown. */
 } instruction_type;
 
@@ -136,6 +142,7 @@ typedef struct function_call
 {
     char * identifier;              /**< The identifier of the function call. */
     expression_list * arguments;    /**< The arguments of the function call. */
+    access_list * accesses;         /**< The annotated accesses, if any. */
 } function_call;
 
 /**
@@ -164,6 +171,17 @@ typedef struct if_then_else
     instruction_list * false_body;  /**< Body when the condition is false. */
 } if_then_else;
 
+/**
+ * \brief Bindings of values to identifiers.
+ * \ingroup instruction_content_group
+ * \since version `1.1.0`
+ */
+typedef struct binding
+{
+    char * identifier;              /**< The bound identifier. */
+    expression * value;             /**< The value. */
+} binding;
+
 //----------------------------------------------------------------------------//
 
 /**
@@ -176,6 +194,8 @@ typedef struct instruction_annotation
     char * level;                   /**< Level in the AST. */
     char * boundaries;              /**< Boundaries. */
     expression * date;              /**< Dates. */
+    struct instruction * origin;    /**< Input instruction it comes from. */
+    unsigned long int superstep;    /**< Phases which may run together. */
 } instruction_annotation;
 
 //----------------------------------------------------------------------------//
@@ -193,9 +213,12 @@ typedef struct instruction
         function_call call;             /**< The function call. */
         for_loop loop;                  /**< The for loop. */
         if_then_else branch;            /**< The branch. */
+        binding bind;                   /**< The binding. */
         instruction_list * block;       /**< The block. */
     } content;                          /**< The instruction's content. */
     instruction_annotation annotation;  /**< The annotation. */
+    struct instruction * parent;        /**< The enclosing instruction. */
+    struct instruction_list * node;     /**< The list node holding it. */
 } instruction;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -208,7 +231,8 @@ typedef struct instruction
  * \brief Create or destroy an ::instruction.
  *
  * An ::instruction can be created using instruction_alloc() and destroyed
- * using instruction_free().
+ * using instruction_free(). An ::instruction can be copied with
+ * instruction_copy().
  */
 
 //----------------------------------------------------------------------------//
@@ -233,6 +257,20 @@ instruction * instruction_alloc (void);
  */
 void instruction_free (instruction  * i);
 
+/**
+ * \brief Copy an instruction.
+ * \relates instruction
+ * \ingroup instruction_management
+ * \since version `1.1.0`
+ *
+ * The annotations are copied as well, but the copy is not linked (see
+ * instruction_list_link()).
+ *
+ * \param i Instruction to copy.
+ * \return The copy.
+ */
+instruction * instruction_copy (const instruction * i);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Constructors.
 ////////////////////////////////////////////////////////////////////////////////
@@ -334,6 +372,20 @@ instruction * instruction_clocked_finish (instruction_list * block);
  */
 instruction * instruction_clocked_async (instruction_list * block);
 
+/**
+ * \brief Build a binding.
+ * \relates instruction
+ * \ingroup instruction_management
+ * \since version `1.1.0`
+ *
+ * \param t Either ::INSTR_VAL, ::INSTR_VAR or ::INSTR_ASSIGN.
+ * \param identifier The bound identifier.
+ * \param value The value.
+ * \return The resulting instruction.
+ */
+instruction * instruction_binding (instruction_type t, char * identifier,
+        expression * value);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Getters.
 ////////////////////////////////////////////////////////////////////////////////
@@ -916,4 +968,16 @@ void for_loop_fprint (FILE * f, const for_loop * instr);
  */
 void instruction_call_fprint (FILE * f, const function_call * instr);
 
+/**
+ * \brief Print a binding to a stream.
+ * \relates instruction
+ * \ingroup instruction_io
+ * \since \version `1.1.0`
+ *
+ * \param f Destination stream.
+ * \param t Either ::INSTR_VAL, ::INSTR_VAR or ::INSTR_ASSIGN.
+ * \param instr Instruction to print.
+ */
+void binding_fprint (FILE * f, instruction_type t, const binding * instr);
+
 #endif /* __INSTRUCTION_H__ */
@@ -107,6 +107,17 @@ void instruction_list_soft_free (instruction_list * list);
  */
 void instruction_list_free (instruction_list * list);
 
+/**
+ * \brief Copy an instruction list.
+ * \relates instruction_list
+ * \ingroup instruction_list_management
+ * \since version `1.1.0`
+ *
+ * \param list The list to copy.
+ * \return The copy.
+ */
+instruction_list * instruction_list_copy (const instruction_list * list);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Operations.
 ////////////////////////////////////////////////////////////////////////////////
@@ -165,10 +176,24 @@ void instruction_list_wrap (instruction_list * list, instruction * instr,
  * \ingroup instruction_list_operation
  * \since version `1.0.0`
  *
+ * The finish and async constructs to rebuild around each call are those
+ * which enclosed its instruction_annotation::origin in the input program
+ * (which must have been linked with instruction_list_link()). The finish
+ * built for a clocked finish holds a single phase, whose date is stored in
+ * its instruction_annotation::date, and how many consecutive phases may run
+ * together in its instruction_annotation::superstep.
+ *
+ * The AST is linked with instruction_list_link() first, so that the enclosing
+ * scopes of each call are reached by following instruction::parent instead of
+ * searching the whole AST.
+ *
  * \param list Input AST.
  * \param calls List of function calls inside the AST.
+ * \param superstep Consecutive phases which may run together (see
+ *        union_map_superstep()).
  */
-void instruction_list_fill (instruction_list * list, instruction_list * calls);
+void instruction_list_fill (instruction_list * list, instruction_list * calls,
+        unsigned long int superstep);
 
 /**
  * \brief Strip an AST of unnecessary information in function calls.
@@ -176,10 +201,13 @@ void instruction_list_fill (instruction_list * list, instruction_list * calls);
  * \ingroup instruction_list_operation
  * \since version `1.0.0`
  *
- * \param list Input AST.
- * \param s List of function identifiers.
+ * Each call gets back the identifier of its instruction_annotation::origin
+ * and only keeps the arguments which are values of loop iterators (the date
+ * and the positions are dropped).
+ *
+ * \param list List of function calls.
  */
-void instruction_list_strip (instruction_list * list, string_list * s);
+void instruction_list_strip (instruction_list * list);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Annotations.
@@ -282,6 +310,20 @@ bool instruction_list_is_indirect_parent (instruction_list * list,
 instruction_list * instruction_list_find_parent (instruction_list * list,
         instruction * instr);
 
+/**
+ * \brief Link the instructions of an AST to their parents.
+ * \relates instruction_list
+ * \ingroup instruction_list_getter
+ * \since version `1.1.0`
+ *
+ * Set instruction::parent and instruction::node for every instruction of the
+ * AST. instruction_list_wrap() keeps these links up to date.
+ *
+ * \param list Input AST.
+ * \param parent Instruction enclosing \a list (`NULL` for the root).
+ */
+void instruction_list_link (instruction_list * list, instruction * parent);
+
 /**
  * \brief Get the list of function calls in an AST.
  * \relates instruction_list
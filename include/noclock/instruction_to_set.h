@@ -33,10 +33,21 @@
 #ifndef __INSTRUCTION_TO_SET_H__
 #define __INSTRUCTION_TO_SET_H__
 
+#include <ctype.h>
+
 #include <isl/ctx.h>
+#include <isl/id.h>
 #include <isl/set.h>
 #include <isl/map.h>
 #include <isl/union_set.h>
+#include <isl/union_map.h>
+#include <isl/aff.h>
+#include <isl/local_space.h>
+#include <isl/val.h>
+#include <isl/stride_info.h>
+#include <isl/flow.h>
+#include <isl/schedule.h>
+#include <isl/schedule_node.h>
 
 #include "noclock/util.h"
 #include "noclock/verbose.h"
@@ -61,13 +72,14 @@
  *
  * \param ctx ISL ctx.
  * \param parameters Parameters.
+ * Each set is named after its call, and the id of its tuple holds a pointer to
+ * the call.
+ *
  * \param instructions No Clock AST.
- * \param s Instruction names.
  * \return ISL list of sets.
  */
 isl_set_list * program_to_set_list (isl_ctx* ctx,
-        const string_list * parameters, const instruction_list * instructions,
-        string_list * s);
+        const string_list * parameters, const instruction_list * instructions);
 
 /**
  * \brief Merge ISL sets into an union.
@@ -79,4 +91,104 @@ isl_set_list * program_to_set_list (isl_ctx* ctx,
  */
 isl_union_set * union_set_list (isl_set_list * list);
 
+/**
+ * \brief Build the schedule of an union of sets.
+ * \ingroup noclock_to_isl_group
+ * \since version `1.1.0`
+ *
+ * Each set is mapped to its own coordinates in an unnamed space, so that the
+ * statements are ordered by date and level, whatever their name.
+ *
+ * \param set Union of sets (consumed).
+ * \return Schedule of the union.
+ */
+isl_union_map * union_set_schedule (isl_union_set * set);
+
+/**
+ * \brief Renumber the dates of a schedule densely.
+ * \ingroup noclock_to_isl_group
+ * \since version `1.1.0`
+ *
+ * When all the statements happen on dates `offset + k * stride`, for a
+ * constant offset and a stride greater than 1, the dates are replaced by
+ * `k`, so that the code never goes through the dates in between, where
+ * nothing happens.
+ *
+ * \param schedule Schedule (consumed), see union_set_schedule().
+ * \return The compressed schedule.
+ */
+isl_union_map * union_map_compress_dates (isl_union_map * schedule);
+
+/**
+ * \brief Replace the dates of a schedule by phases following the dependences.
+ * \ingroup noclock_to_isl_group
+ * \since version `1.1.0`
+ *
+ * The dependences are computed from the accesses annotated on the calls (see
+ * ::access_list). The calls without annotations keep their clock order with
+ * respect to every other call. Two instances of a same activity must not be
+ * reordered, and two instances of different activities and dates must end
+ * up in different phases, in the same order.
+ *
+ * The phases are all `0` if possible, otherwise one phase per statement,
+ * otherwise the first dimension of the schedule computed by the ISL
+ * scheduler. The dates are kept when none fits, or when no call is annotated.
+ *
+ * Looking for wavefronts, the sum of the dimensions of the outermost
+ * permutable band of the ISL scheduler is tried as well, and the phases
+ * with the shortest critical path are kept, ahead of the dates if need be.
+ * The length of each critical path is reported in verbose mode.
+ *
+ * \param schedule Schedule (consumed), see union_set_schedule().
+ * \param parameters Parameters.
+ * \param wavefront Whether to look for the shortest critical path.
+ * \return The relaxed schedule.
+ */
+isl_union_map * union_map_relax_dates (isl_union_map * schedule,
+        const string_list * parameters, bool wavefront);
+
+/**
+ * \brief Tile a schedule along the dates and the loops.
+ * \ingroup noclock_to_isl_group
+ * \since version `1.1.0`
+ *
+ * The first size tiles the dates, the next ones tile the loops enclosing
+ * each call, outermost first. The tiles come before the dates in the
+ * schedule, so that every phase of a tile is run before the next tile.
+ *
+ * Rectangular tiles are tried first, then parallelograms skewed along the
+ * dates. The schedule is returned untouched if no tiling keeps the clock
+ * order (see union_map_relax_dates()).
+ *
+ * \param schedule Schedule (consumed), see union_set_schedule().
+ * \param parameters Parameters.
+ * \param sizes Tile sizes (`0` or `1` for no tiling).
+ * \param count Number of sizes.
+ * \return The tiled schedule.
+ */
+isl_union_map * union_map_tile (isl_union_map * schedule,
+        const string_list * parameters, const unsigned long int * sizes,
+        size_t count);
+
+/**
+ * \brief Count the consecutive phases which may run together.
+ * \ingroup noclock_to_isl_group
+ * \since version `1.1.0`
+ *
+ * Phases closer than the shortest dependence between instances of different
+ * dates, along the first dimension of the schedule, touch independent
+ * instances (see union_map_relax_dates() for the dependences). Without
+ * accesses, each phase depends on the previous one through the clock, and
+ * the result is `1`.
+ *
+ * The result is reported in verbose mode.
+ *
+ * \param schedule Schedule (kept), see union_set_schedule().
+ * \param parameters Parameters.
+ * \param limit Largest result.
+ * \return The number of phases, from `1` to \p limit.
+ */
+unsigned long int union_map_superstep (isl_union_map * schedule,
+        const string_list * parameters, unsigned long int limit);
+
 #endif /* __INSTRUCTION_TO_SET_H__ */
@@ -0,0 +1,116 @@
+/**
+ * \file instrument.h
+ * \brief Timing probes.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __INSTRUMENT_H__
+#define __INSTRUMENT_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/expression_list.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup instrument_group Timing probes.
+ * \brief Time the finishes, asyncs and phases of a program.
+ * \since version `1.1.0`
+ *
+ * Probes are calls to `noclock_probe_enter (id, value)` and
+ * `noclock_probe_exit (id, value)`, so that every back end prints them like
+ * any other call. They are added:
+ *
+ * - around each finish, which they time until all its activities are done.
+ * - within each async, around its body.
+ * - within each loop of phases, around the body of each iteration. A loop
+ *   holds phases when its body waits for a finish or reaches an advance
+ *   outside of any async.
+ *
+ * The ids are given in program order, so that they do not change as long as
+ * the printed program does not. The value is the iterator of the innermost
+ * enclosing loop (the loop itself for phases), or `0`.
+ *
+ * Each probe is described by a line of the probe map:
+ *
+ * ~~~
+ * <id> <kind> <loop> <statements> <calls>
+ * ~~~
+ *
+ * where `<kind>` is `finish`, `async` or `phase`, `<loop>` is the innermost
+ * enclosing loop (`-` if none), `<statements>` are the calls it times,
+ * separated by commas, and `<calls>` is the number of calls it times each
+ * time (`-` when it depends on loops, conditions or other activities). The probes are implemented by the trace runtime (see
+ * `runtime/noclock_trace.h`).
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Kinds of probes.
+ * \ingroup instrument_group
+ * \since version `1.1.0`
+ */
+typedef enum probe_kind
+{
+    PROBE_FINISH,       /**< Around a finish. */
+    PROBE_ASYNC,        /**< Around the body of an async. */
+    PROBE_PHASE,        /**< Around an iteration of a loop of phases. */
+    PROBE_UNKNOWN,      /**< Number of kinds. */
+} probe_kind;
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Add timing probes to a program.
+ * \ingroup instrument_group
+ * \since version `1.1.0`
+ *
+ * The instruction::parent and instruction::node links are not maintained.
+ *
+ * \param list Program (modified).
+ * \param map Output file of the probe map, or `NULL`.
+ * \return The instrumented program.
+ */
+instruction_list * instruction_list_instrument (instruction_list * list,
+        FILE * map);
+
+#endif /* __INSTRUMENT_H__ */
@@ -0,0 +1,182 @@
+/**
+ * \file interpreter.h
+ * \brief Parallel interpreter.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __INTERPRETER_H__
+#define __INTERPRETER_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <dlfcn.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/expression_list.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup interpreter_group Parallel interpreter.
+ * \brief Run programs without compiling them.
+ * \since version `1.1.0`
+ *
+ * Both the input programs, with their clocks, and the final programs can be
+ * run on a pool of workers:
+ *
+ * - the asyncs are spread among the workers by work stealing. A worker
+ *   waiting for a finish runs other asyncs meanwhile.
+ * - the clocked asyncs run on threads of their own, since they block until
+ *   the end of their phases. An `advance` waits until every activity
+ *   registered on the clock of the innermost clocked finish has reached it;
+ *   outside of any clocked async, it does nothing.
+ * - the *S* instructions call the functions of the same name of a shared
+ *   object, as `S (long * arguments, int count)`.
+ *
+ * The interpreter measures the phases of the program. A phase ends when the
+ * main activity completes a finish, when a clocked finish of the main
+ * activity starts a new phase, and at the end of the program if activities
+ * ended since the previous phase.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Functions called by the *S* instructions.
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ */
+typedef void (* interpreter_kernel) (long * arguments, int count);
+
+/**
+ * \brief Measures of a phase.
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ */
+typedef struct interpreter_phase
+{
+    double seconds;                 /**< Duration. */
+    unsigned long int activities;   /**< Activities registered on the clock,
+                                      or ended during the phase. */
+} interpreter_phase;
+
+/**
+ * \brief Measures of a run.
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ */
+typedef struct interpreter_stats
+{
+    size_t workers;                 /**< Number of workers. */
+    double seconds;                 /**< Wall time. */
+    unsigned long int activities;   /**< Number of asyncs. */
+    unsigned long int calls;        /**< Number of *S* instructions. */
+    size_t phase_count;             /**< Number of phases. */
+    size_t phase_size;              /**< Allocated phases. */
+    interpreter_phase * phases;     /**< The phases, in order. */
+} interpreter_stats;
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation, initialization, copy, cleaning, free.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Initialize measures.
+ * \relates interpreter_stats
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ *
+ * \param stats Measures.
+ */
+void interpreter_stats_init (interpreter_stats * stats);
+
+/**
+ * \brief Clean measures.
+ * \relates interpreter_stats
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ *
+ * \param stats Measures.
+ */
+void interpreter_stats_clean (interpreter_stats * stats);
+
+////////////////////////////////////////////////////////////////////////////////
+// Running.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Run a program.
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ *
+ * Errors are reported on the standard error output.
+ *
+ * \param list The program, with or without clocks.
+ * \param parameters Parameters of the program.
+ * \param values Values of the parameters, in the same order.
+ * \param library Shared object holding the *S* functions, or `NULL` for
+ *                calls which do nothing.
+ * \param workers Number of workers, `0` for one per processor.
+ * \param stats Measures to fill (see interpreter_stats_init()).
+ * \retval EXIT_SUCCESS if the program ran.
+ * \retval EX_NOINPUT if the shared object could not be loaded.
+ * \retval EX_DATAERR if a function is missing from the shared object.
+ */
+int instruction_list_run (const instruction_list * list,
+        const string_list * parameters, const long int * values,
+        const char * library, size_t workers, interpreter_stats * stats);
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print measures.
+ * \ingroup interpreter_group
+ * \since version `1.1.0`
+ *
+ * \param f Output file.
+ * \param stats Measures.
+ */
+void interpreter_stats_fprint (FILE * f, const interpreter_stats * stats);
+
+#endif /* __INTERPRETER_H__ */
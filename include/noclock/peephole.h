@@ -0,0 +1,126 @@
+/**
+ * \file peephole.h
+ * \brief Peephole optimizations of NoClock ASTs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PEEPHOLE_H__
+#define __PEEPHOLE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+
+/**
+ * \defgroup peephole_group Peephole optimizations.
+ * \brief Remove useless finish and async blocks.
+ * \since version `1.1.0`
+ *
+ * Each finish or async costs activity spawns and termination detection at
+ * runtime. The reconstructed ASTs are rewritten with the following rules,
+ * until none applies:
+ *
+ * - ::PEEPHOLE_FINISH_ASYNC: `finish { async { X } }` becomes
+ *   `finish { X }`.
+ * - ::PEEPHOLE_ASYNC_ASYNC: `async { async { X } }` becomes `async { X }`.
+ * - ::PEEPHOLE_FINISH_SYNC: `finish { X }` becomes `X` when `X` does not
+ *   spawn any activity.
+ * - ::PEEPHOLE_FINISH_MERGE: adjacent finish blocks holding the same phase
+ *   of the same clocked finish (see instruction_list_fill()) are merged,
+ *   since the calls of a phase are independent. The dates of two clocked
+ *   finishes, which both start at 0, never match.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Rewriting rules.
+ * \ingroup peephole_group
+ * \since version `1.1.0`
+ */
+typedef enum peephole_rule
+{
+    PEEPHOLE_FINISH_ASYNC,  /**< `finish { async { X } }` */
+    PEEPHOLE_ASYNC_ASYNC,   /**< `async { async { X } }` */
+    PEEPHOLE_FINISH_SYNC,   /**< `finish { X }` without any async in X. */
+    PEEPHOLE_FINISH_MERGE,  /**< Adjacent finish blocks of a same phase. */
+    PEEPHOLE_UNKNOWN,       /**< Number of rules. */
+} peephole_rule;
+
+/**
+ * \brief Number of applications of each rule.
+ * \ingroup peephole_group
+ * \since version `1.1.0`
+ */
+typedef struct peephole_stats
+{
+    size_t count[PEEPHOLE_UNKNOWN];     /**< Applications per rule. */
+} peephole_stats;
+
+////////////////////////////////////////////////////////////////////////////////
+// Optimizations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Apply the peephole rules to an AST until none applies.
+ * \ingroup peephole_group
+ * \since version `1.1.0`
+ *
+ * The instruction::parent and instruction::node links are not maintained.
+ *
+ * \param list Input AST (modified).
+ * \param stats Counters to increment, or `NULL`.
+ * \return The optimized AST.
+ */
+instruction_list * instruction_list_peephole (instruction_list * list,
+        peephole_stats * stats);
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print the counters of the peephole rules.
+ * \ingroup peephole_group
+ * \since version `1.1.0`
+ *
+ * \param f Output file.
+ * \param stats Counters.
+ */
+void peephole_stats_fprint (FILE * f, const peephole_stats * stats);
+
+#endif /* __PEEPHOLE_H__ */
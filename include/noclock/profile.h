@@ -0,0 +1,139 @@
+/**
+ * \file profile.h
+ * \brief Times of the statements, measured by a training run.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup profile_group Profiles.
+ * \brief Times of the statements, measured by a training run.
+ * \since version `1.1.0`
+ *
+ * Static trip counts say nothing of how long each call takes. A profile
+ * gives the mean time of a call to each statement, in nanoseconds, one
+ * statement per line:
+ *
+ * ~~~
+ * S0 1250.5
+ * S1 84
+ * ~~~
+ *
+ * Empty lines and lines starting with `#` are ignored. The `noclock-trace`
+ * tool writes such a profile from the trace of a program printed with
+ * `--instrument`.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Times of the statements.
+ * \ingroup profile_group
+ * \since version `1.1.0`
+ */
+typedef struct profile
+{
+    string_list statements;     /**< Profiled statements. */
+    double * times;             /**< Their times, in nanoseconds. */
+} profile;
+
+////////////////////////////////////////////////////////////////////////////////
+// Init, clean.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Initialize an empty profile.
+ * \relates profile
+ * \ingroup profile_group
+ * \since version `1.1.0`
+ *
+ * \param p Profile.
+ */
+void profile_init (profile * p);
+
+/**
+ * \brief Clean a profile.
+ * \relates profile
+ * \ingroup profile_group
+ * \since version `1.1.0`
+ *
+ * \param p Profile.
+ */
+void profile_clean (profile * p);
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Read a profile.
+ * \relates profile
+ * \ingroup profile_group
+ * \since version `1.1.0`
+ *
+ * A statement given several times keeps its last time.
+ *
+ * \param p Profile (modified).
+ * \param f Input file.
+ * \return The number of the first malformed line, or `0`.
+ */
+size_t profile_fscan (profile * p, FILE * f);
+
+////////////////////////////////////////////////////////////////////////////////
+// Getters.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Get the time of a statement.
+ * \relates profile
+ * \ingroup profile_group
+ * \since version `1.1.0`
+ *
+ * \param p Profile.
+ * \param statement Identifier of the statement.
+ * \param time Its time, in nanoseconds.
+ * \retval true if the statement is profiled.
+ */
+bool profile_time (const profile * p, const char * statement, double * time);
+
+#endif /* __PROFILE_H__ */
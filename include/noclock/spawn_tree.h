@@ -0,0 +1,102 @@
+/**
+ * \file spawn_tree.h
+ * \brief Divide-and-conquer spawning of parallel loops.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __SPAWN_TREE_H__
+#define __SPAWN_TREE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+
+/**
+ * \defgroup spawn_tree_group Spawn trees.
+ * \brief Spawn the activities of a parallel loop from a binary tree.
+ * \since version `1.1.0`
+ *
+ * A loop whose body is a single async spawns all its activities from the
+ * same activity, one after the other:
+ *
+ * ~~~
+ * for i in (lo..hi)
+ *     async
+ *         X
+ * ~~~
+ *
+ * The iteration range is cut into `2^D` leaves of (nearly) equal sizes, and
+ * the leaves are spawned from a binary tree: each activity spawns the first
+ * half of its leaves and runs the second half itself. With a depth of 2:
+ *
+ * ~~~
+ * async
+ * {
+ *     async
+ *     {
+ *         async
+ *             for i in (b0..(b1 - 1)) async X
+ *         for i in (b1..(b2 - 1)) async X
+ *     }
+ *     async
+ *         for i in (b2..(b3 - 1)) async X
+ *     for i in (b3..hi) async X
+ * }
+ * ~~~
+ *
+ * where `bk = lo + (k * (hi - lo + 1)) / 4`. NoClock has no recursion: the
+ * tree is unrolled up to the requested depth, and the leaves keep the
+ * original loop. The activities remain under the same finish, so the program
+ * keeps every ordering it had.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Spawn the activities of the parallel loops from binary trees.
+ * \ingroup spawn_tree_group
+ * \since version `1.1.0`
+ *
+ * Loops whose trip count is known are not split below one iteration per
+ * leaf.
+ *
+ * \param list Input AST (modified).
+ * \param depth Depth of the trees. Nothing happens with a depth of `0`.
+ */
+void instruction_list_spawn_tree (instruction_list * list, unsigned int depth);
+
+#endif /* __SPAWN_TREE_H__ */
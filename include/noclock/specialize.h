@@ -0,0 +1,121 @@
+/**
+ * \file specialize.h
+ * \brief Replace parameters by their values and unroll short loops.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef __SPECIALIZE_H__
+#define __SPECIALIZE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/expression_list.h"
+#include "noclock/access_list.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/string_list.h"
+
+/**
+ * \defgroup specialize_group Specialization.
+ * \brief Replace parameters by their values.
+ * \since version `1.1.0`
+ *
+ * Programs deployed with fixed parameters need not keep them symbolic. Each
+ * occurrence of a parameter, in boundaries, conditions, arguments and
+ * accesses, is replaced by its value and the expressions are folded:
+ *
+ * ~~~
+ * for (i in 0..(M-1))
+ *     if (M >= 2)
+ *         S0 (i, M);
+ * ~~~
+ *
+ * becomes, with `M = 4`:
+ *
+ * ~~~
+ * for (i in 0..3)
+ *     S0 (i, 4);
+ * ~~~
+ *
+ * Branches whose condition folds to a constant are replaced by the branch
+ * taken. Since this happens before the dates are computed, the domains of
+ * the statements only hold constants, and ISL simplifies the loops and the
+ * guards of the final program accordingly. Loop iterators hide the
+ * parameters of the same name.
+ *
+ * The loops of the final program which are then left with a handful of
+ * iterations can be fully unrolled: each iteration becomes a copy of the
+ * body, specialized in the same way for the value of the iterator.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Replace parameters by their values.
+ * \ingroup specialize_group
+ * \since version `1.1.0`
+ *
+ * The instruction::parent and instruction::node links are not maintained.
+ *
+ * \param list Input AST (modified).
+ * \param names The parameters to replace.
+ * \param values Their values, in the same order.
+ * \return The specialized AST.
+ */
+instruction_list * instruction_list_specialize (instruction_list * list,
+        const string_list * names, const long int * values);
+
+/**
+ * \brief Fully unroll the loops of constant boundaries.
+ * \ingroup specialize_group
+ * \since version `1.1.0`
+ *
+ * Loops running between one and \p limit iterations are replaced by one copy
+ * of their body per iteration, outermost loops first. Nothing is unrolled
+ * when \p limit is `0`.
+ *
+ * The instruction::parent and instruction::node links are not maintained.
+ *
+ * \param list Input AST (modified).
+ * \param limit Maximum number of iterations of an unrolled loop.
+ * \return The unrolled AST.
+ */
+instruction_list * instruction_list_unroll (instruction_list * list,
+        unsigned long int limit);
+
+#endif /* __SPECIALIZE_H__ */
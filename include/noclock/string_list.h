@@ -154,7 +154,7 @@ size_t string_list_append (string_list * list, const char * s);
  * \return Index of the first occurence of the string if it exists.
  * \retval -1 if the string does not exist.
  */
-ssize_t string_list_index (string_list * list, const char * s);
+ssize_t string_list_index (const string_list * list, const char * s);
 
 /**
  * \brief Get the string at an index.
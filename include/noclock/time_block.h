@@ -0,0 +1,108 @@
+/**
+ * \file time_block.h
+ * \brief Temporal blocking of clock phases.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TIME_BLOCK_H__
+#define __TIME_BLOCK_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+#include "noclock/cost.h"
+
+/**
+ * \defgroup time_block_group Temporal blocking.
+ * \brief Synchronize once per group of consecutive phases.
+ * \since version `1.1.0`
+ *
+ * Once the clocks are removed, each date of a clocked finish is an iteration
+ * of a loop whose body is the finish of that phase:
+ *
+ * ~~~
+ * for c0 in (lo..hi)
+ *     finish
+ *         X
+ * ~~~
+ *
+ * The dates are tiled by a factor K, and a single finish waits for the K
+ * phases of each superstep:
+ *
+ * ~~~
+ * for c0_block in (0..((hi - lo) / K))
+ *     finish
+ *         for c0 in ((lo + (K * c0_block))..min (hi, ((lo + (K * c0_block)) + (K - 1))))
+ *             X
+ * ~~~
+ *
+ * The phases of a superstep are no longer ordered: K is at most the number
+ * of consecutive phases without dependences between them, as computed by
+ * union_map_superstep() and recorded on the finish of each phase. Without
+ * accesses, each phase depends on the previous one, and nothing is tiled.
+ */
+
+/**
+ * \brief Largest number of phases per superstep chosen automatically.
+ * \ingroup time_block_group
+ * \since version `1.1.0`
+ */
+#define TIME_BLOCK_AUTO 64
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Tile the dates of the phases of clocked finishes.
+ * \ingroup time_block_group
+ * \since version `1.1.0`
+ *
+ * Only the loops whose body is the finish of a single phase (see
+ * instruction_list_fill()) are tiled, by at most \p factor and at most the
+ * instruction_annotation::superstep of that finish. A factor of `0` stands
+ * for #TIME_BLOCK_AUTO, and nothing happens with a factor of `1`. When a
+ * profile gives the time of every statement of a phase, its loop only gets
+ * as many phases per superstep as needed to amortize the finish (see
+ * cost_grain()).
+ *
+ * \param list Input AST (modified).
+ * \param factor Number of phases per superstep, or `0`.
+ * \param model What is known of the run.
+ */
+void instruction_list_block_phases (instruction_list * list,
+        unsigned long int factor, const cost_model * model);
+
+#endif /* __TIME_BLOCK_H__ */
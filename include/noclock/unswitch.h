@@ -0,0 +1,114 @@
+/**
+ * \file unswitch.h
+ * \brief Loop unswitching.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __UNSWITCH_H__
+#define __UNSWITCH_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "noclock/util.h"
+#include "noclock/expression.h"
+#include "noclock/instruction.h"
+#include "noclock/instruction_list.h"
+
+/**
+ * \defgroup unswitch_group Loop unswitching.
+ * \brief Evaluate loop-invariant conditions once per loop.
+ * \since version `1.1.0`
+ *
+ * The conditions of the branches reconstructed from ISL often depend only
+ * on the parameters or on the iterators of enclosing loops, yet they are
+ * evaluated at each iteration:
+ *
+ * ~~~
+ * for c0 in (lo..hi)
+ *     finish
+ *     {
+ *         for c1 in (0..c0)
+ *             async
+ *                 S0 (c0, c1);
+ *         if ((N >= 2))
+ *             async
+ *                 S1 (c0);
+ *     }
+ * ~~~
+ *
+ * The branch is moved out of the loop, which is duplicated:
+ *
+ * ~~~
+ * if ((N >= 2))
+ *     for c0 in (lo..hi)
+ *         finish
+ *         {
+ *             for c1 in (0..c0)
+ *                 async
+ *                     S0 (c0, c1);
+ *             async
+ *                 S1 (c0);
+ *         }
+ * else
+ *     for c0 in (lo..hi)
+ *         finish
+ *             for c1 in (0..c0)
+ *                 async
+ *                     S0 (c0, c1);
+ * ~~~
+ *
+ * The finish and async blocks around the branch (see
+ * instruction_list_fill()) are kept in both versions, except for those left
+ * empty.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Move the loop-invariant branches out of the loops.
+ * \ingroup unswitch_group
+ * \since version `1.1.0`
+ *
+ * Each unswitching duplicates a loop. The loops are unswitched from the
+ * innermost ones, as long as the number of duplicated instructions stays
+ * within the budget. Loops binding identifiers (see
+ * instruction_list_hoist()) are left untouched.
+ *
+ * \param list Input AST (modified).
+ * \param budget Maximum number of duplicated instructions.
+ */
+void instruction_list_unswitch (instruction_list * list, size_t budget);
+
+#endif /* __UNSWITCH_H__ */
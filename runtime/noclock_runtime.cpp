@@ -0,0 +1,353 @@
+/**
+ * \file noclock_runtime.cpp
+ * \brief Work-stealing runtime of the C++ back end.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "noclock_runtime.hpp"
+
+namespace noclock
+{
+    namespace
+    {
+        ////////////////////////////////////////////////////////////////////////
+        // Chase-Lev deques.
+        ////////////////////////////////////////////////////////////////////////
+
+        /* Work-stealing deque of suspended activities, after "Correct and
+         * Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013).
+         * Only the owner pushes and pops, at the bottom; thieves take from the
+         * top.
+         */
+        class deque
+        {
+        public:
+            deque () : array (new ring (64)) { }
+
+            ~deque ()
+            {
+                delete array.load (std::memory_order_relaxed);
+                for (ring * r : retired)
+                    delete r;
+            }
+
+            void push (void * x)
+            {
+                long b = bottom.load (std::memory_order_relaxed);
+                long t = top.load (std::memory_order_acquire);
+                ring * a = array.load (std::memory_order_relaxed);
+
+                if (b - t > a->mask)
+                    a = grow (a, t, b);
+
+                a->put (b, x);
+                std::atomic_thread_fence (std::memory_order_release);
+                bottom.store (b + 1, std::memory_order_relaxed);
+            }
+
+            void * pop ()
+            {
+                long b = bottom.load (std::memory_order_relaxed) - 1;
+                ring * a = array.load (std::memory_order_relaxed);
+                bottom.store (b, std::memory_order_relaxed);
+                std::atomic_thread_fence (std::memory_order_seq_cst);
+                long t = top.load (std::memory_order_relaxed);
+
+                void * x = nullptr;
+                if (t <= b)
+                {
+                    x = a->get (b);
+                    if (t == b)
+                    {
+                        /* Last one: race against the thieves. */
+                        if (! top.compare_exchange_strong (t, t + 1,
+                                    std::memory_order_seq_cst,
+                                    std::memory_order_relaxed))
+                            x = nullptr;
+                        bottom.store (b + 1, std::memory_order_relaxed);
+                    }
+                }
+                else
+                    bottom.store (b + 1, std::memory_order_relaxed);
+
+                return x;
+            }
+
+            /* Only meaningful for the owner. */
+            long size () const
+            {
+                return bottom.load (std::memory_order_relaxed)
+                    - top.load (std::memory_order_relaxed);
+            }
+
+            void * steal ()
+            {
+                long t = top.load (std::memory_order_acquire);
+                std::atomic_thread_fence (std::memory_order_seq_cst);
+                long b = bottom.load (std::memory_order_acquire);
+
+                if (t >= b)
+                    return nullptr;
+
+                ring * a = array.load (std::memory_order_acquire);
+                void * x = a->get (t);
+                if (! top.compare_exchange_strong (t, t + 1,
+                            std::memory_order_seq_cst,
+                            std::memory_order_relaxed))
+                    return nullptr;
+
+                return x;
+            }
+
+        private:
+            struct ring
+            {
+                explicit ring (long size)
+                    : mask (size - 1), slots (new std::atomic<void *>[size]) { }
+
+                void * get (long i) const
+                {
+                    return slots[i & mask].load (std::memory_order_relaxed);
+                }
+
+                void put (long i, void * x)
+                {
+                    slots[i & mask].store (x, std::memory_order_relaxed);
+                }
+
+                long mask;
+                std::unique_ptr<std::atomic<void *>[]> slots;
+            };
+
+            /* Thieves may still read the old ring: it is only released with
+             * the deque.
+             */
+            ring * grow (ring * a, long t, long b)
+            {
+                ring * bigger = new ring (2 * (a->mask + 1));
+                for (long i = t; i < b; ++i)
+                    bigger->put (i, a->get (i));
+                retired.push_back (a);
+                array.store (bigger, std::memory_order_release);
+                return bigger;
+            }
+
+            alignas (64) std::atomic<long> top { 0 };
+            alignas (64) std::atomic<long> bottom { 0 };
+            std::atomic<ring *> array;
+            std::vector<ring *> retired;
+        };
+
+        ////////////////////////////////////////////////////////////////////////
+        // Workers.
+        ////////////////////////////////////////////////////////////////////////
+
+        struct worker
+        {
+            deque tasks;
+            unsigned long int seed;     /* For the choice of victims. */
+        };
+
+        struct pool
+        {
+            std::vector<std::unique_ptr<worker>> workers;
+            std::atomic<bool> stop { false };
+        };
+
+        thread_local worker * current = nullptr;
+
+        /* Beyond this many activities in a deque, spawns run right away. */
+        constexpr long cutoff = 256;
+
+        unsigned int default_workers ()
+        {
+            const char * value = std::getenv ("NOCLOCK_WORKERS");
+            unsigned long int n = value != nullptr
+                ? std::strtoul (value, nullptr, 10) : 0;
+            if (n == 0)
+                n = std::thread::hardware_concurrency ();
+            return n > 0 ? (unsigned int) n : 1;
+        }
+
+        /* Take a task from the worker's own deque, or else from another. */
+        void * find (pool & p, worker & self)
+        {
+            void * x = self.tasks.pop ();
+            if (x != nullptr)
+                return x;
+
+            std::size_t n = p.workers.size ();
+            for (std::size_t attempt = 0; attempt < n; ++attempt)
+            {
+                self.seed ^= self.seed << 13;
+                self.seed ^= self.seed >> 7;
+                self.seed ^= self.seed << 17;
+                worker & victim = * p.workers[self.seed % n];
+                if (& victim != & self && (x = victim.tasks.steal ()) != nullptr)
+                    return x;
+            }
+
+            return nullptr;
+        }
+
+        template <typename Done>
+        void work (pool & p, worker & self, Done done)
+        {
+            current = & self;
+
+            unsigned int idle = 0;
+            while (! done ())
+            {
+                void * x = find (p, self);
+                if (x != nullptr)
+                {
+                    std::coroutine_handle<>::from_address (x).resume ();
+                    idle = 0;
+                }
+                else if (++idle > 64)
+                    std::this_thread::yield ();
+            }
+
+            current = nullptr;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        // Frame pools.
+        ////////////////////////////////////////////////////////////////////////
+
+        /* Frames are recycled by size classes of 64 bytes, up to 1 KiB.
+         * A frame goes back to the pool of the thread which destroys it.
+         */
+        constexpr std::size_t granularity = 64;
+        constexpr std::size_t classes = 16;
+
+        struct frame_pool
+        {
+            struct node { node * next; };
+            node * free[classes] = { };
+
+            ~frame_pool ()
+            {
+                for (node * head : free)
+                    while (head != nullptr)
+                    {
+                        node * next = head->next;
+                        ::operator delete (head);
+                        head = next;
+                    }
+            }
+        };
+
+        thread_local frame_pool frames;
+    }
+
+    namespace detail
+    {
+        bool push (std::coroutine_handle<> h) noexcept
+        {
+            if (current->tasks.size () >= cutoff)
+                return false;
+
+            current->tasks.push (h.address ());
+            return true;
+        }
+
+        void * allocate (std::size_t size)
+        {
+            std::size_t c = (size - 1) / granularity;
+            if (c >= classes)
+                return ::operator new (size);
+
+            frame_pool::node * head = frames.free[c];
+            if (head == nullptr)
+                return ::operator new ((c + 1) * granularity);
+
+            frames.free[c] = head->next;
+            return head;
+        }
+
+        void deallocate (void * p, std::size_t size) noexcept
+        {
+            std::size_t c = (size - 1) / granularity;
+            if (c >= classes)
+            {
+                ::operator delete (p);
+                return;
+            }
+
+            frame_pool::node * node = static_cast<frame_pool::node *> (p);
+            node->next = frames.free[c];
+            frames.free[c] = node;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Running.
+    ////////////////////////////////////////////////////////////////////////////
+
+    void run (task && t, unsigned int workers)
+    {
+        if (workers == 0)
+            workers = default_workers ();
+
+        pool p;
+        for (unsigned int w = 0; w < workers; ++w)
+        {
+            p.workers.push_back (std::make_unique<worker> ());
+            p.workers.back ()->seed = 2654435761ul * (w + 1);
+        }
+
+        std::vector<std::thread> threads;
+        for (unsigned int w = 1; w < workers; ++w)
+            threads.emplace_back ([& p, w] ()
+            {
+                work (p, * p.workers[w], [& p] ()
+                {
+                    return p.stop.load (std::memory_order_acquire);
+                });
+            });
+
+        /* The calling thread is the first worker. */
+        finish root;
+        current = p.workers[0].get ();
+        root.spawn (std::move (t));
+        work (p, * p.workers[0], [& root] () { return root.done (); });
+
+        p.stop.store (true, std::memory_order_release);
+        for (std::thread & thread : threads)
+            thread.join ();
+    }
+}
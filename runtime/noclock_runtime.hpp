@@ -0,0 +1,264 @@
+/**
+ * \file noclock_runtime.hpp
+ * \brief Work-stealing runtime of the C++ back end.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __NOCLOCK_RUNTIME_HPP__
+#define __NOCLOCK_RUNTIME_HPP__
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+/**
+ * \defgroup runtime_group Work-stealing runtime.
+ * \brief Run the programs printed by `--emit=cpp-coro`.
+ * \since version `1.1.0`
+ *
+ * Activities are C++20 coroutines (::noclock::task) spawned within a
+ * ::noclock::finish, which they signal when they are done:
+ *
+ * ~~~{.cpp}
+ * noclock::task program (long N)
+ * {
+ *     noclock::finish f0;
+ *     for (long i = 0; i <= N - 1; ++i)
+ *         f0.spawn ([] (noclock::finish & f0, long i) -> noclock::task
+ *         {
+ *             S0 (i);
+ *             co_return;
+ *         } (f0, i));
+ *     co_await f0;
+ * }
+ *
+ * noclock::run (program (N));
+ * ~~~
+ *
+ * Each worker owns a Chase-Lev deque: spawning pushes the activity at the
+ * bottom of the deque of the current worker, which pops from the bottom while
+ * idle workers steal from the top. When the deque already holds enough
+ * activities, the new one runs right away instead, so that loops spawning
+ * many activities do not keep them all suspended at once. Awaiting a finish suspends the activity
+ * until its last child completes, and the last child resumes it directly.
+ * The coroutine frames are recycled by per-worker pools, so that a spawn does
+ * not go through the allocator.
+ *
+ * The number of workers is the number of processors, unless the environment
+ * variable `NOCLOCK_WORKERS` says otherwise.
+ */
+
+namespace noclock
+{
+    class finish;
+    class task;
+
+    /**
+     * \brief Run an activity and every activity it spawns.
+     * \ingroup runtime_group
+     * \since version `1.1.0`
+     *
+     * The calling thread is one of the workers.
+     *
+     * \param t The activity.
+     * \param workers Number of workers, `0` for the default.
+     */
+    void run (task && t, unsigned int workers = 0);
+
+    namespace detail
+    {
+        /* Push a suspended activity on the deque of the current worker,
+         * unless it already holds enough to keep the thieves busy.
+         */
+        bool push (std::coroutine_handle<> h) noexcept;
+
+        /* Coroutine frames, from the pool of the current thread. */
+        void * allocate (std::size_t size);
+        void deallocate (void * p, std::size_t size) noexcept;
+    }
+
+    /**
+     * \brief Activity.
+     * \ingroup runtime_group
+     * \since version `1.1.0`
+     *
+     * A task is suspended until it is spawned, and its frame is destroyed
+     * as soon as it completes.
+     */
+    class task
+    {
+    public:
+        struct promise_type
+        {
+            finish * parent = nullptr;  /**< The finish waiting for it. */
+
+            task get_return_object () noexcept
+            {
+                return task (
+                    std::coroutine_handle<promise_type>::from_promise (* this));
+            }
+
+            std::suspend_always initial_suspend () noexcept { return {}; }
+
+            struct final_awaiter
+            {
+                bool await_ready () noexcept { return false; }
+                std::coroutine_handle<> await_suspend (
+                        std::coroutine_handle<promise_type> h) noexcept;
+                void await_resume () noexcept { }
+            };
+
+            final_awaiter final_suspend () noexcept { return {}; }
+            void return_void () noexcept { }
+            void unhandled_exception () noexcept { std::terminate (); }
+
+            static void * operator new (std::size_t size)
+            {
+                return detail::allocate (size);
+            }
+
+            static void operator delete (void * p, std::size_t size) noexcept
+            {
+                detail::deallocate (p, size);
+            }
+        };
+
+        task (task && other) noexcept
+            : handle (std::exchange (other.handle, nullptr)) { }
+        task (const task &) = delete;
+        task & operator= (const task &) = delete;
+        task & operator= (task &&) = delete;
+
+        ~task ()
+        {
+            if (handle)
+                handle.destroy ();
+        }
+
+    private:
+        explicit task (std::coroutine_handle<promise_type> h) noexcept
+            : handle (h) { }
+
+        std::coroutine_handle<promise_type> handle;
+
+        friend class finish;
+    };
+
+    /**
+     * \brief Finish block.
+     * \ingroup runtime_group
+     * \since version `1.1.0`
+     *
+     * The counter holds one reference for the owner, dropped when it awaits
+     * the finish, and one per running child: whoever drops the last one
+     * resumes the owner.
+     */
+    class finish
+    {
+    public:
+        finish () noexcept = default;
+        finish (const finish &) = delete;
+        finish & operator= (const finish &) = delete;
+
+        /**
+         * \brief Spawn an activity within this finish.
+         *
+         * \param t The activity.
+         */
+        void spawn (task && t) noexcept
+        {
+            std::coroutine_handle<task::promise_type> h =
+                std::exchange (t.handle, nullptr);
+            h.promise ().parent = this;
+            pending.fetch_add (1, std::memory_order_relaxed);
+
+            /* The spawner holds a reference on this finish, so the child
+             * cannot resume the owner when it is run right away.
+             */
+            if (! detail::push (h))
+                h.resume ();
+        }
+
+        struct awaiter
+        {
+            finish & f;
+
+            bool await_ready () noexcept { return f.done (); }
+
+            bool await_suspend (std::coroutine_handle<> h) noexcept
+            {
+                f.waiter = h;
+                return f.pending.fetch_sub (1, std::memory_order_acq_rel) != 1;
+            }
+
+            void await_resume () noexcept { }
+        };
+
+        /**
+         * \brief Wait for the activities spawned within this finish.
+         *
+         * A finish can only be awaited once.
+         */
+        awaiter operator co_await () noexcept { return { * this }; }
+
+    private:
+        std::atomic<long> pending { 1 };
+        std::coroutine_handle<> waiter;
+
+        bool done () const noexcept
+        {
+            return pending.load (std::memory_order_acquire) == 1;
+        }
+
+        /* A child is done: the owner to resume, if it was the last one. */
+        std::coroutine_handle<> complete () noexcept
+        {
+            if (pending.fetch_sub (1, std::memory_order_acq_rel) == 1)
+                return waiter;
+            return std::noop_coroutine ();
+        }
+
+        friend struct task::promise_type::final_awaiter;
+        friend void run (task && t, unsigned int workers);
+    };
+
+    inline std::coroutine_handle<>
+    task::promise_type::final_awaiter::await_suspend (
+            std::coroutine_handle<promise_type> h) noexcept
+    {
+        finish * parent = h.promise ().parent;
+        h.destroy ();
+        return parent->complete ();
+    }
+}
+
+#endif /* __NOCLOCK_RUNTIME_HPP__ */
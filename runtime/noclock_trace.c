@@ -0,0 +1,240 @@
+/**
+ * \file noclock_trace.c
+ * \brief Timing probes of instrumented programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "noclock_trace.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/** Records per buffer. */
+#define _BUFFER_SIZE 4096
+
+/**
+ * \brief Records of a thread not yet written.
+ * \since version `1.1.0`
+ */
+typedef struct _buffer
+{
+    noclock_trace_record records[_BUFFER_SIZE];     /**< The records. */
+    size_t count;                                   /**< Their number. */
+    uint32_t thread;                                /**< The thread. */
+    struct _buffer * next;                          /**< Other buffers. */
+} _buffer;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/** Protects the trace and the list of buffers. */
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** The trace, once opened. */
+static FILE * _trace = NULL;
+
+/** Whether the trace could not be opened. */
+static bool _disabled = false;
+
+/** Time of the first probe. */
+static uint64_t _start = 0;
+
+/** Buffers of all the threads, written when the program exits. */
+static _buffer * _buffers = NULL;
+
+/** Number of threads. */
+static uint32_t _threads = 0;
+
+/** Buffer of the current thread. */
+static __thread _buffer * _current = NULL;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Read the monotonic clock.
+ * \return Nanoseconds.
+ */
+static uint64_t _now (void);
+
+/**
+ * \brief Write the records of a buffer to the trace.
+ * \param b Buffer.
+ * \pre The lock is held.
+ */
+static void _flush (_buffer * b);
+
+/**
+ * \brief Write every buffer and close the trace (see atexit()).
+ */
+static void _close (void);
+
+/**
+ * \brief Get the buffer of the current thread, opening the trace if needed.
+ * \return The buffer, or `NULL` if there is no trace.
+ */
+static _buffer * _get (void);
+
+/**
+ * \brief Record a probe.
+ * \param probe Id of the probe, and whether it exits.
+ * \param value Iterator of the enclosing loop.
+ */
+static void _record (uint32_t probe, long value);
+
+////////////////////////////////////////////////////////////////////////////////
+// Probes.
+////////////////////////////////////////////////////////////////////////////////
+
+void noclock_probe_enter (long probe, long value)
+{
+    _record ((uint32_t) probe, value);
+}
+
+void noclock_probe_exit (long probe, long value)
+{
+    _record ((uint32_t) probe | NOCLOCK_TRACE_EXIT, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t _now (void)
+{
+    struct timespec t;
+    clock_gettime (CLOCK_MONOTONIC, & t);
+    return (uint64_t) t.tv_sec * 1000000000u + (uint64_t) t.tv_nsec;
+}
+
+void _flush (_buffer * b)
+{
+    if (fwrite (b->records, sizeof * b->records, b->count, _trace) != b->count)
+        perror ("fwrite");
+    b->count = 0;
+}
+
+void _close (void)
+{
+    pthread_mutex_lock (& _lock);
+    for (_buffer * b = _buffers; b != NULL; b = b->next)
+        _flush (b);
+    fclose (_trace);
+    _trace = NULL;
+    _disabled = true;
+    pthread_mutex_unlock (& _lock);
+}
+
+_buffer * _get (void)
+{
+    if (_current != NULL)
+        return _current;
+
+    pthread_mutex_lock (& _lock);
+
+    /* The first probe opens the trace. */
+    if (_trace == NULL && ! _disabled)
+    {
+        const char * name = getenv ("NOCLOCK_TRACE");
+        _trace = fopen (name != NULL ? name : "noclock.trace", "wb");
+        if (_trace == NULL)
+        {
+            perror (name != NULL ? name : "noclock.trace");
+            _disabled = true;
+        }
+        else
+        {
+            fwrite (NOCLOCK_TRACE_MAGIC, 1, sizeof NOCLOCK_TRACE_MAGIC - 1,
+                    _trace);
+            _start = _now ();
+            atexit (_close);
+        }
+    }
+
+    /* The buffers are only released with the process: those of the threads
+     * which are done are still written when it exits.
+     */
+    _buffer * b = NULL;
+    if (! _disabled)
+    {
+        b = malloc (sizeof * b);
+        if (b == NULL)
+        {
+            perror ("malloc");
+            exit (EXIT_FAILURE);
+        }
+        b->count = 0;
+        b->thread = _threads++;
+        b->next = _buffers;
+        _buffers = b;
+    }
+
+    pthread_mutex_unlock (& _lock);
+
+    _current = b;
+    return b;
+}
+
+void _record (uint32_t probe, long value)
+{
+    _buffer * b = _get ();
+    if (b == NULL)
+        return;
+
+    if (b->count == _BUFFER_SIZE)
+    {
+        pthread_mutex_lock (& _lock);
+        if (_trace != NULL)
+            _flush (b);
+        else
+            b->count = 0;
+        pthread_mutex_unlock (& _lock);
+    }
+
+    b->records[b->count++] = (noclock_trace_record)
+    {
+        .time = _now () - _start,
+        .value = value,
+        .probe = probe,
+        .thread = b->thread,
+    };
+}
@@ -0,0 +1,114 @@
+/**
+ * \file noclock_trace.h
+ * \brief Timing probes of instrumented programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef __NOCLOCK_TRACE_H__
+#define __NOCLOCK_TRACE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup trace_group Traces.
+ * \brief Record the probes of programs printed with `--instrument`.
+ * \since version `1.1.0`
+ *
+ * Each thread records the probes it reaches into a buffer of its own, which
+ * is written to the trace when full and when the program exits. The trace is
+ * the file named by the `NOCLOCK_TRACE` environment variable, or
+ * `noclock.trace`: ::NOCLOCK_TRACE_MAGIC, then ::noclock_trace_record
+ * structures in the byte order of the machine.
+ *
+ * The `noclock-trace` tool sums the records per probe, per phase and per
+ * statement, and may write the profile read by `noclock --profile-use`:
+ *
+ * ~~~
+ * $ noclock-trace noclock.trace probes.map [statements.profile]
+ * ~~~
+ */
+
+/**
+ * \brief First bytes of a trace.
+ * \ingroup trace_group
+ * \since version `1.1.0`
+ */
+#define NOCLOCK_TRACE_MAGIC "NCTRACE1"
+
+/**
+ * \brief Bit of noclock_trace_record::probe set for exits.
+ * \ingroup trace_group
+ * \since version `1.1.0`
+ */
+#define NOCLOCK_TRACE_EXIT 0x80000000u
+
+/**
+ * \brief A probe reached by a thread.
+ * \ingroup trace_group
+ * \since version `1.1.0`
+ */
+typedef struct noclock_trace_record
+{
+    uint64_t time;          /**< Nanoseconds since the first probe. */
+    int64_t value;          /**< Iterator of the enclosing loop. */
+    uint32_t probe;         /**< Id of the probe, and whether it exits. */
+    uint32_t thread;        /**< Thread, numbered from 0. */
+} noclock_trace_record;
+
+/**
+ * \brief Enter a finish, an async or a phase.
+ * \ingroup trace_group
+ * \since version `1.1.0`
+ *
+ * \param probe Id of the probe.
+ * \param value Iterator of the enclosing loop.
+ */
+void noclock_probe_enter (long probe, long value);
+
+/**
+ * \brief Leave a finish, an async or a phase.
+ * \ingroup trace_group
+ * \since version `1.1.0`
+ *
+ * \param probe Id of the probe.
+ * \param value Iterator of the enclosing loop.
+ */
+void noclock_probe_exit (long probe, long value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NOCLOCK_TRACE_H__ */
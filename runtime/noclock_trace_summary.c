@@ -0,0 +1,546 @@
+/**
+ * \file noclock_trace_summary.c
+ * \brief Summarize the traces of instrumented programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ *
+ * ~~~
+ * $ noclock-trace <trace> [<probe map> [<profile>]]
+ * ~~~
+ *
+ * Prints, for each probe, how many times it was entered and the time spent
+ * within it. With the probe map printed by `noclock --instrument`, it also
+ * prints the time of each phase and the time of the asyncs per statement.
+ *
+ * With a third argument, it also writes the mean time of a call to each
+ * statement, as read by `noclock --profile-use`. Only the asyncs which time
+ * a known number of calls to a single statement are taken into account.
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sysexits.h>
+
+#include "noclock_trace.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Time spent in one iteration of a loop of phases.
+ * \since version `1.1.0`
+ */
+typedef struct _iteration
+{
+    int64_t value;          /**< Iterator of the loop. */
+    int64_t total;          /**< Nanoseconds. */
+} _iteration;
+
+/**
+ * \brief What is known of a probe.
+ * \since version `1.1.0`
+ */
+typedef struct _probe
+{
+    char * kind;            /**< Kind, from the map. */
+    char * loop;            /**< Enclosing loop, from the map. */
+    char * statements;      /**< Statements, from the map. */
+    size_t calls;           /**< Calls timed, from the map, or `0`. */
+    size_t enters;          /**< Number of enters. */
+    size_t exits;           /**< Number of exits. */
+    int64_t total;          /**< Sum of the exits minus sum of the enters. */
+    _iteration * iterations;    /**< Iterations, for phases. */
+    size_t length;          /**< Number of iterations. */
+    size_t size;            /**< Allocated iterations. */
+} _probe;
+
+/**
+ * \brief Time spent in the asyncs of some statements.
+ * \since version `1.1.0`
+ */
+typedef struct _statement
+{
+    const char * statements;    /**< The statements. */
+    size_t count;               /**< Number of asyncs. */
+    int64_t total;              /**< Nanoseconds. */
+} _statement;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/** The probes, by id. */
+static _probe * _probes = NULL;
+
+/** Number of probes. */
+static size_t _length = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Abort on a failed allocation.
+ * \param p Allocated memory.
+ * \return \p p.
+ */
+static void * _checked (void * p);
+
+/**
+ * \brief Get a probe, growing the table if needed.
+ * \param id Id of the probe.
+ * \return The probe.
+ */
+static _probe * _get (size_t id);
+
+/**
+ * \brief Read a probe map.
+ * \param name Name of the map.
+ * \retval 0 if it was read.
+ * \retval -1 otherwise.
+ */
+static int _read_map (const char * name);
+
+/**
+ * \brief Read a trace.
+ * \param name Name of the trace.
+ * \param records Set to the number of records read.
+ * \param threads Set to the number of threads.
+ * \param duration Set to the time of the last record.
+ * \retval 0 if it was read.
+ * \retval -1 otherwise.
+ */
+static int _read_trace (const char * name, size_t * records, size_t * threads,
+        uint64_t * duration);
+
+/**
+ * \brief Add a record to the iterations of its probe.
+ * \param p The probe.
+ * \param r The record.
+ */
+static void _iterate (_probe * p, const noclock_trace_record * r);
+
+/**
+ * \brief Print the probes.
+ */
+static void _probes_print (void);
+
+/**
+ * \brief Print the phases.
+ */
+static void _phases_print (void);
+
+/**
+ * \brief Print the asyncs per statement.
+ */
+static void _statements_print (void);
+
+/**
+ * \brief Write the mean time of a call to each statement.
+ * \param name Name of the profile.
+ * \retval 0 if it was written.
+ * \retval -1 otherwise.
+ */
+static int _profile_write (const char * name);
+
+/**
+ * \brief Release the probes.
+ */
+static void _clean (void);
+
+////////////////////////////////////////////////////////////////////////////////
+// Main.
+////////////////////////////////////////////////////////////////////////////////
+
+int main (int argc, char ** argv)
+{
+    if (argc < 2 || argc > 4)
+    {
+        fprintf (stderr, "Usage: %s <trace> [<probe map> [<profile>]]\n",
+                argv[0]);
+        return EX_USAGE;
+    }
+
+    if (argc >= 3 && _read_map (argv[2]) != 0)
+    {
+        _clean ();
+        return EX_NOINPUT;
+    }
+
+    size_t records, threads;
+    uint64_t duration;
+    if (_read_trace (argv[1], & records, & threads, & duration) != 0)
+    {
+        _clean ();
+        return EX_DATAERR;
+    }
+
+    printf ("Trace: %zu records, %zu threads, %.3f ms\n", records, threads,
+            (double) duration / 1e6);
+    _probes_print ();
+    _phases_print ();
+    _statements_print ();
+
+    int status = EX_OK;
+    if (argc == 4 && _profile_write (argv[3]) != 0)
+        status = EX_CANTCREAT;
+
+    _clean ();
+    return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void * _checked (void * p)
+{
+    if (p == NULL)
+    {
+        perror ("malloc");
+        exit (EX_OSERR);
+    }
+    return p;
+}
+
+_probe * _get (size_t id)
+{
+    if (id >= _length)
+    {
+        size_t length = id + 1 > 2 * _length ? id + 1 : 2 * _length;
+        _probes = _checked (realloc (_probes, length * sizeof * _probes));
+        memset (_probes + _length, 0, (length - _length) * sizeof * _probes);
+        _length = length;
+    }
+    return & _probes[id];
+}
+
+int _read_map (const char * name)
+{
+    FILE * f = fopen (name, "r");
+    if (f == NULL)
+    {
+        perror (name);
+        return -1;
+    }
+
+    char * line = NULL;
+    size_t size = 0;
+    size_t number = 0;
+    int result = 0;
+    while (getline (& line, & size, f) != -1)
+    {
+        ++number;
+        char * end;
+        size_t id = strtoul (line, & end, 10);
+        char * kind = strtok (end, " \t\n");
+        char * loop = strtok (NULL, " \t\n");
+        char * statements = strtok (NULL, " \t\n");
+        char * calls = strtok (NULL, " \t\n");
+        if (end == line || statements == NULL)
+        {
+            fprintf (stderr, "%s:%zu: malformed probe\n", name, number);
+            result = -1;
+            break;
+        }
+
+        _probe * p = _get (id);
+        free (p->kind);
+        free (p->loop);
+        free (p->statements);
+        p->kind = _checked (strdup (kind));
+        p->loop = _checked (strdup (loop));
+        p->statements = _checked (strdup (statements));
+        p->calls = calls != NULL ? strtoul (calls, NULL, 10) : 0;
+    }
+
+    free (line);
+    fclose (f);
+    return result;
+}
+
+int _read_trace (const char * name, size_t * records, size_t * threads,
+        uint64_t * duration)
+{
+    FILE * f = fopen (name, "rb");
+    if (f == NULL)
+    {
+        perror (name);
+        return -1;
+    }
+
+    char magic[sizeof NOCLOCK_TRACE_MAGIC - 1];
+    if (fread (magic, 1, sizeof magic, f) != sizeof magic
+            || memcmp (magic, NOCLOCK_TRACE_MAGIC, sizeof magic) != 0)
+    {
+        fprintf (stderr, "%s: not a trace\n", name);
+        fclose (f);
+        return -1;
+    }
+
+    * records = 0;
+    * threads = 0;
+    * duration = 0;
+
+    noclock_trace_record buffer[4096];
+    size_t count;
+    while ((count = fread (buffer, sizeof * buffer, 4096, f)) > 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const noclock_trace_record * r = & buffer[i];
+            _probe * p = _get (r->probe & ~NOCLOCK_TRACE_EXIT);
+
+            /* The total does not depend on which exit matches which enter. */
+            if (r->probe & NOCLOCK_TRACE_EXIT)
+            {
+                ++p->exits;
+                p->total += (int64_t) r->time;
+            }
+            else
+            {
+                ++p->enters;
+                p->total -= (int64_t) r->time;
+            }
+
+            if (p->kind != NULL && strcmp (p->kind, "phase") == 0)
+                _iterate (p, r);
+
+            if (r->thread >= * threads)
+                * threads = r->thread + 1;
+            if (r->time > * duration)
+                * duration = r->time;
+        }
+        * records += count;
+    }
+
+    int result = 0;
+    if (ferror (f))
+    {
+        perror (name);
+        result = -1;
+    }
+    fclose (f);
+    return result;
+}
+
+void _iterate (_probe * p, const noclock_trace_record * r)
+{
+    /* The iterations of a loop usually come in order. */
+    size_t i = p->length;
+    while (i > 0 && p->iterations[i - 1].value != r->value)
+        --i;
+
+    if (i == 0)
+    {
+        if (p->length == p->size)
+        {
+            p->size = p->size > 0 ? 2 * p->size : 16;
+            p->iterations = _checked (realloc (p->iterations,
+                        p->size * sizeof * p->iterations));
+        }
+        p->iterations[p->length++] = (_iteration) { .value = r->value };
+        i = p->length;
+    }
+
+    if (r->probe & NOCLOCK_TRACE_EXIT)
+        p->iterations[i - 1].total += (int64_t) r->time;
+    else
+        p->iterations[i - 1].total -= (int64_t) r->time;
+}
+
+void _probes_print (void)
+{
+    printf ("\nProbes:\n%6s %-7s %-8s %10s %14s %12s  %s\n", "id", "kind",
+            "loop", "count", "total (ms)", "mean (us)", "statements");
+
+    for (size_t id = 0; id < _length; ++id)
+    {
+        const _probe * p = & _probes[id];
+        if (p->enters == 0 && p->exits == 0)
+            continue;
+
+        printf ("%6zu %-7s %-8s %10zu %14.3f %12.3f  %s%s\n", id,
+                p->kind != NULL ? p->kind : "-",
+                p->loop != NULL ? p->loop : "-", p->enters,
+                (double) p->total / 1e6,
+                p->enters > 0 ? (double) p->total / 1e3 / (double) p->enters
+                    : 0.0,
+                p->statements != NULL ? p->statements : "-",
+                p->enters != p->exits ? " (unbalanced)" : "");
+    }
+}
+
+void _phases_print (void)
+{
+    bool printed = false;
+    for (size_t id = 0; id < _length; ++id)
+    {
+        const _probe * p = & _probes[id];
+        if (p->length == 0)
+            continue;
+
+        if (! printed)
+            printf ("\nPhases:\n%6s %-8s %10s %12s %12s %12s %12s\n", "id",
+                    "loop", "iterations", "min (us)", "mean (us)", "max (us)",
+                    "slowest");
+        printed = true;
+
+        size_t slowest = 0, fastest = 0;
+        for (size_t i = 1; i < p->length; ++i)
+        {
+            if (p->iterations[i].total > p->iterations[slowest].total)
+                slowest = i;
+            if (p->iterations[i].total < p->iterations[fastest].total)
+                fastest = i;
+        }
+
+        printf ("%6zu %-8s %10zu %12.3f %12.3f %12.3f %12" PRId64 "\n", id,
+                p->loop, p->length,
+                (double) p->iterations[fastest].total / 1e3,
+                (double) p->total / 1e3 / (double) p->length,
+                (double) p->iterations[slowest].total / 1e3,
+                p->iterations[slowest].value);
+    }
+}
+
+void _statements_print (void)
+{
+    _statement * statements = _checked (malloc ((_length + 1)
+                * sizeof * statements));
+    size_t length = 0;
+
+    for (size_t id = 0; id < _length; ++id)
+    {
+        const _probe * p = & _probes[id];
+        if (p->kind == NULL || strcmp (p->kind, "async") != 0
+                || p->enters == 0)
+            continue;
+
+        size_t i = 0;
+        while (i < length && strcmp (statements[i].statements,
+                    p->statements) != 0)
+            ++i;
+        if (i == length)
+            statements[length++] = (_statement)
+            {
+                .statements = p->statements,
+            };
+        statements[i].count += p->enters;
+        statements[i].total += p->total;
+    }
+
+    if (length > 0)
+        printf ("\nStatements:\n%-24s %10s %14s %12s\n", "statements",
+                "asyncs", "total (ms)", "mean (us)");
+    for (size_t i = 0; i < length; ++i)
+        printf ("%-24s %10zu %14.3f %12.3f\n", statements[i].statements,
+                statements[i].count, (double) statements[i].total / 1e6,
+                (double) statements[i].total / 1e3
+                    / (double) statements[i].count);
+
+    free (statements);
+}
+
+int _profile_write (const char * name)
+{
+    FILE * f = fopen (name, "w");
+    if (f == NULL)
+    {
+        perror (name);
+        return -1;
+    }
+
+    fprintf (f, "# Nanoseconds per call.\n");
+
+    /* Sum the asyncs of each statement, in the order of the probes. */
+    for (size_t id = 0; id < _length; ++id)
+    {
+        const _probe * p = & _probes[id];
+        if (p->kind == NULL || strcmp (p->kind, "async") != 0
+                || p->calls == 0 || strchr (p->statements, ',') != NULL)
+            continue;
+
+        bool first = true;
+        for (size_t other = 0; other < id && first; ++other)
+            first = _probes[other].kind == NULL
+                || strcmp (_probes[other].kind, "async") != 0
+                || _probes[other].calls == 0
+                || strcmp (_probes[other].statements, p->statements) != 0;
+        if (! first)
+            continue;
+
+        double calls = 0;
+        double total = 0;
+        for (size_t other = id; other < _length; ++other)
+        {
+            const _probe * q = & _probes[other];
+            if (q->kind != NULL && strcmp (q->kind, "async") == 0
+                    && q->calls > 0
+                    && strcmp (q->statements, p->statements) == 0)
+            {
+                calls += (double) q->enters * (double) q->calls;
+                total += (double) q->total;
+            }
+        }
+
+        if (calls > 0)
+            fprintf (f, "%s %.1f\n", p->statements, total / calls);
+    }
+
+    int result = 0;
+    if (fclose (f) != 0)
+    {
+        perror (name);
+        result = -1;
+    }
+    return result;
+}
+
+void _clean (void)
+{
+    for (size_t id = 0; id < _length; ++id)
+    {
+        free (_probes[id].kind);
+        free (_probes[id].loop);
+        free (_probes[id].statements);
+        free (_probes[id].iterations);
+    }
+    free (_probes);
+    _probes = NULL;
+    _length = 0;
+}
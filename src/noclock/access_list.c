@@ -0,0 +1,158 @@
+/**
+ * \file access_list.c
+ * \brief Array accesses of function calls.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "noclock/access_list.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation, initialization, copy, cleaning, free.
+////////////////////////////////////////////////////////////////////////////////
+
+access_list * access_list_alloc (char * array, expression_list * indices)
+{
+    access_list * list = malloc (sizeof * list);
+    __forbid_value (list, NULL, "malloc", EX_OSERR);
+    list->array = array;
+    list->indices = indices;
+    list->write = false;
+    list->next = NULL;
+
+    return list;
+}
+
+void access_list_free (access_list * list)
+{
+    access_list * current, * tmp;
+    for (current = list; current != NULL; current = tmp)
+    {
+        tmp = current->next;
+        free (current->array);
+        expression_list_free (current->indices);
+        free (current);
+    }
+}
+
+access_list * access_list_copy (const access_list * list)
+{
+    access_list * copy = NULL;
+
+    for (const access_list * current = list; current != NULL;
+            current = current->next)
+    {
+        char * array = strdup (current->array);
+        __forbid_value (array, NULL, "strdup", EX_OSERR);
+        access_list * node = access_list_alloc (array,
+                expression_list_copy (current->indices));
+        node->write = current->write;
+        copy = access_list_cat (copy, node);
+    }
+
+    return copy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Operations.
+////////////////////////////////////////////////////////////////////////////////
+
+access_list * access_list_cat (access_list * a, access_list * b)
+{
+    if (a != NULL)
+    {
+        access_list * last;
+        for (last = a; last->next != NULL; last = last->next)
+            ;
+        last->next = b;
+    }
+    else
+        a = b;
+
+    return a;
+}
+
+access_list * access_list_set_write (access_list * list, bool write)
+{
+    for (access_list * current = list; current != NULL;
+            current = current->next)
+        current->write = write;
+
+    return list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+void access_list_fprint (FILE * f, const access_list * list)
+{
+    bool colours = pretty_print_colour_state ();
+
+    /* Reads first, then writes. */
+    for (int write = 0; write < 2; ++write)
+    {
+        const char * keyword = write ? "writes" : "reads";
+        bool first = true;
+        for (const access_list * current = list; current != NULL;
+                current = current->next)
+        {
+            if (current->write != (bool) write)
+                continue;
+
+            if (! first)
+                fprintf (f, ", ");
+            else if (colours)
+                fprintf (f, " " PP_KEYWORD "%s" PP_RESET " ", keyword);
+            else
+                fprintf (f, " %s ", keyword);
+            first = false;
+
+            fprintf (f, "%s", current->array);
+            for (const expression_list * i = current->indices; i != NULL;
+                    i = i->next)
+            {
+                fprintf (f, "[");
+                expression_fprint (f, i->element);
+                fprintf (f, "]");
+            }
+        }
+    }
+}
+
+char * access_list_to_string (const access_list * list)
+{
+    char * indices = expression_list_to_string (list->indices, ", ");
+    char * string = malloc (strlen (list->array) + strlen (indices) + 4);
+    __forbid_value (string, NULL, "malloc", EX_OSERR);
+    sprintf (string, "%s[%s]", list->array, indices);
+    free (indices);
+
+    return string;
+}
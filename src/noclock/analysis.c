@@ -0,0 +1,943 @@
+/**
+ * \file analysis.c
+ * \brief Work and parallelism of NoClock programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/analysis.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief State of the walk through a program.
+ * \since version `1.1.0`
+ *
+ * The identifiers bound by loops and vals are renamed `_l0`, `_l1`, ... in
+ * the sets, since inner loops may reuse the identifiers of outer ones.
+ */
+typedef struct _walk
+{
+    analysis * a;                   /**< The analysis. */
+    bool calls;                     /**< Whether to gather the calls. */
+    string_list names;              /**< The bound identifiers. */
+    string_list constraints;        /**< The constraints on them. */
+    char * phase;                   /**< The tuple of the current phase. */
+    bool async;                     /**< Whether within an async. */
+} _walk;
+
+/**
+ * \brief Region of an input program.
+ * \since version `1.1.0`
+ */
+typedef struct _region
+{
+    analysis * a;                   /**< The analysis. */
+    long int index;                 /**< Its place in the program. */
+} _region;
+
+/**
+ * \brief Counts for given values of the parameters.
+ * \since version `1.1.0`
+ */
+typedef struct _counts
+{
+    const analysis * a;             /**< The analysis. */
+    const long int * values;        /**< Values of the parameters. */
+    isl_union_map * instances;      /**< Instances of each phase. */
+    long int count;                 /**< Number of points so far. */
+    long int total;                 /**< Instances within phases. */
+    long int widest;                /**< Instances of the widest phase. */
+} _counts;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Unbind the identifiers beyond a length.
+ * \param list Identifiers or constraints.
+ * \param length Length to keep.
+ */
+static void _truncate (string_list * list, size_t length);
+
+/**
+ * \brief Whether an expression only involves numbers.
+ * \param e Expression.
+ * \retval true if so.
+ */
+static bool _constant (const expression * e);
+
+/**
+ * \brief Print an expression in the syntax of ISL.
+ * \param f Output file.
+ * \param e Expression.
+ * \param w Walk.
+ * \retval true if the expression is affine.
+ */
+static bool _affine_fprint (FILE * f, const expression * e, const _walk * w);
+
+/**
+ * \brief Print a condition, or its negation, in the syntax of ISL.
+ * \param f Output file.
+ * \param e Condition.
+ * \param negate Whether to print its negation.
+ * \param w Walk.
+ * \retval true if the condition is affine.
+ */
+static bool _condition_fprint (FILE * f, const expression * e, bool negate,
+        const _walk * w);
+
+/**
+ * \brief Print the tuple of a statement within the current loops.
+ * \param f Output file.
+ * \param prefix Kind of statement.
+ * \param index Number of the statement.
+ * \param depth Number of dimensions.
+ */
+static void _tuple_fprint (FILE * f, char prefix, size_t index, size_t depth);
+
+/**
+ * \brief Bind an identifier within the current block.
+ * \param w Walk.
+ * \param identifier Identifier.
+ * \param e1 First expression of the constraint.
+ * \param e2 Second expression of the constraint, or `NULL`.
+ */
+static void _bind (_walk * w, const char * identifier, const expression * e1,
+        const expression * e2);
+
+/**
+ * \brief Add an instance set for the current loops.
+ * \param w Walk.
+ * \param prefix Kind of statement: `S`, `A` or `F`.
+ * \return The tuple of the statement.
+ */
+static char * _statement (_walk * w, char prefix);
+
+/**
+ * \brief Walk through a block: its bindings end with it.
+ * \param w Walk.
+ * \param list Instructions.
+ */
+static void _walk_block (_walk * w, const instruction_list * list);
+
+/**
+ * \brief Walk through an instruction.
+ * \param w Walk.
+ * \param instr Instruction.
+ */
+static void _walk_instruction (_walk * w, const instruction * instr);
+
+/**
+ * \brief Gather the calls of an input region with their dates.
+ * \param set Set of a call (see program_to_set_list()).
+ * \param user The region.
+ * \return `0`.
+ */
+static int _set_dates (isl_set * set, void * user);
+
+/**
+ * \brief Give its value to each parameter of a set.
+ * \param set Set.
+ * \param a Analysis.
+ * \param values Values of the parameters.
+ * \return The set, without parameters left.
+ */
+static isl_set * _set_fix (isl_set * set, const analysis * a,
+        const long int * values);
+
+/**
+ * \brief Count the points of a set for given values of the parameters.
+ * \param set Set.
+ * \param user The counts.
+ * \return `0`.
+ */
+static int _set_count (isl_set * set, void * user);
+
+/**
+ * \brief Count the instances of a phase.
+ * \param point The phase.
+ * \param user The counts.
+ * \return `0`.
+ */
+static int _point_phase (isl_point * point, void * user);
+
+/**
+ * \brief Reverse a map and give its value to each parameter.
+ * \param map Map.
+ * \param user The counts.
+ * \return `0`.
+ */
+static int _map_reverse (isl_map * map, void * user);
+
+/**
+ * \brief Count the points of an union of sets for given values.
+ * \param a Analysis.
+ * \param u Union of sets.
+ * \param values Values of the parameters.
+ * \return The number of points.
+ */
+static long int _count (const analysis * a, isl_union_set * u,
+        const long int * values);
+
+#ifdef NOCLOCK_BARVINOK
+/**
+ * \brief Add a quasi-polynomial to a sum.
+ * \param pwqp Quasi-polynomial.
+ * \param user The sum.
+ * \return `0`.
+ */
+static int _sum (isl_pw_qpolynomial * pwqp, void * user);
+
+/**
+ * \brief Keep the maximum of bounds.
+ * \param pwf Bound.
+ * \param user The maximum.
+ * \return `0`.
+ */
+static int _max (isl_pw_qpolynomial_fold * pwf, void * user);
+
+/**
+ * \brief Print the number of points of an union of sets, symbolically.
+ * \param f Output file.
+ * \param u Union of sets (consumed).
+ */
+static void _card_fprint (FILE * f, isl_union_set * u);
+
+/**
+ * \brief Print the maximum number of instances per phase, symbolically.
+ * \param f Output file.
+ * \param phases Phase of each instance (consumed).
+ */
+static void _widest_fprint (FILE * f, isl_union_map * phases);
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation, initialization, copy, cleaning, free.
+////////////////////////////////////////////////////////////////////////////////
+
+void analysis_init (analysis * a, const string_list * parameters)
+{
+    a->ctx = isl_ctx_alloc ();
+    a->parameters = parameters;
+    a->affine = true;
+    a->statements = 0;
+
+    /* Every set is read with all the parameters. */
+    isl_space * space = isl_space_params_alloc (a->ctx, 0);
+    for (size_t p = 0; p < parameters->length; ++p)
+    {
+        isl_id * id = isl_id_alloc (a->ctx, parameters->list[p], NULL);
+        space = isl_space_add_dims (space, isl_dim_param, 1);
+        space = isl_space_set_dim_id (space, isl_dim_param, (unsigned) p, id);
+    }
+
+    a->calls = isl_union_set_empty (isl_space_copy (space));
+    a->phases = isl_union_map_empty (isl_space_copy (space));
+    a->asyncs = isl_union_set_empty (isl_space_copy (space));
+    a->finishes = isl_union_set_empty (space);
+}
+
+void analysis_clean (analysis * a)
+{
+    isl_union_set_free (a->calls);
+    isl_union_map_free (a->phases);
+    isl_union_set_free (a->asyncs);
+    isl_union_set_free (a->finishes);
+    isl_ctx_free (a->ctx);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Analysis.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_analyze (analysis * a, const instruction_list * list,
+        bool dates)
+{
+    /* The dates are computed on copies of each top-level instruction, which
+     * is where they start over.
+     */
+    if (dates)
+    {
+        _region r = { .a = a, .index = 0 };
+        for (const instruction_list * l = list; l != NULL; l = l->next)
+        {
+            instruction_list region = { instruction_copy (l->element), NULL };
+            instruction_list_compute_dates (& region, NULL, NULL);
+            instruction_list_decorate (& region, NULL, NULL);
+
+            /* The calls whose sets cannot be read are left out. */
+            isl_ctx_reset_error (a->ctx);
+            isl_set_list * sets = program_to_set_list (a->ctx, a->parameters,
+                    & region);
+            if (isl_ctx_last_error (a->ctx) != isl_error_none)
+                a->affine = false;
+            isl_set_list_foreach (sets, _set_dates, & r);
+            isl_set_list_free (sets);
+
+            instruction_free (region.element);
+            ++r.index;
+        }
+    }
+
+    _walk w;
+    w.a = a;
+    w.calls = ! dates;
+    string_list_init (& w.names);
+    string_list_init (& w.constraints);
+    w.phase = NULL;
+    w.async = false;
+
+    _walk_block (& w, list);
+
+    string_list_clean (& w.names);
+    string_list_clean (& w.constraints);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+void analysis_fprint (FILE * f, const analysis * a, const long int * values)
+{
+    static const char * labels[] =
+    {
+        "work", "phases", "max per phase", "average per phase", "asyncs",
+        "finishes",
+    };
+
+    /* Counts for the given values. */
+    long int numbers[6] = { 0 };
+    double average = 0;
+    if (values != NULL && a->affine)
+    {
+        numbers[0] = _count (a, a->calls, values);
+        numbers[4] = _count (a, a->asyncs, values);
+        numbers[5] = _count (a, a->finishes, values);
+
+        _counts c =
+        {
+            .a = a,
+            .values = values,
+            .instances = isl_union_map_empty (isl_union_map_get_space (
+                        a->phases)),
+            .count = 0,
+            .total = 0,
+            .widest = 0,
+        };
+        isl_union_map_foreach_map (a->phases, _map_reverse, & c);
+        isl_union_set * phases = isl_union_map_domain (
+                isl_union_map_copy (c.instances));
+        isl_union_set_foreach_point (phases, _point_phase, & c);
+        isl_union_set_free (phases);
+        isl_union_map_free (c.instances);
+
+        numbers[1] = c.count;
+        numbers[2] = c.widest;
+        average = c.count > 0 ? (double) c.total / (double) c.count : 0;
+    }
+
+    for (size_t i = 0; i < sizeof labels / sizeof * labels; ++i)
+    {
+        fprintf (f, "%-20s", labels[i]);
+
+        if (! a->affine)
+        {
+            fprintf (f, "unknown (not affine)\n");
+            continue;
+        }
+
+        bool symbolic = false;
+#ifdef NOCLOCK_BARVINOK
+        symbolic = i != 3;
+        switch (i)
+        {
+            case 0:
+                _card_fprint (f, isl_union_set_copy (a->calls));
+                break;
+            case 1:
+                _card_fprint (f, isl_union_map_range (
+                            isl_union_map_copy (a->phases)));
+                break;
+            case 2:
+                _widest_fprint (f, isl_union_map_copy (a->phases));
+                break;
+            case 4:
+                _card_fprint (f, isl_union_set_copy (a->asyncs));
+                break;
+            case 5:
+                _card_fprint (f, isl_union_set_copy (a->finishes));
+                break;
+            default:
+                break;
+        }
+#endif
+
+        if (values != NULL)
+        {
+            fprintf (f, symbolic ? " = " : "");
+            if (i == 3)
+                fprintf (f, "%.2f", average);
+            else
+                fprintf (f, "%ld", numbers[i]);
+        }
+        else if (! symbolic)
+            fprintf (f, "?");
+        fprintf (f, "\n");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _truncate (string_list * list, size_t length)
+{
+    while (list->length > length)
+        free (list->list[--list->length]);
+}
+
+bool _constant (const expression * e)
+{
+    if (e == NULL)
+        return true;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+            return false;
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+            return true;
+        default:
+            return _constant (e->content.operands.left)
+                && _constant (e->content.operands.right);
+    }
+}
+
+bool _affine_fprint (FILE * f, const expression * e, const _walk * w)
+{
+    if (e == NULL)
+        return false;
+
+    const expression * l = e->content.operands.left;
+    const expression * r = e->content.operands.right;
+    bool affine = true;
+    switch (e->type)
+    {
+        case EXPR_ADD:
+        case EXPR_SUB:
+        case EXPR_MULT:
+            /* ISL only multiplies by constants. */
+            if (e->type == EXPR_MULT && ! _constant (l) && ! _constant (r))
+                return false;
+            fprintf (f, "(");
+            affine = _affine_fprint (f, l, w);
+            fprintf (f, e->type == EXPR_ADD ? " + "
+                    : e->type == EXPR_SUB ? " - " : " * ");
+            affine = _affine_fprint (f, r, w) && affine;
+            fprintf (f, ")");
+            break;
+        case EXPR_DIV:
+            if (! _constant (r))
+                return false;
+            fprintf (f, "floor(");
+            affine = _affine_fprint (f, l, w);
+            fprintf (f, " / ");
+            affine = _affine_fprint (f, r, w) && affine;
+            fprintf (f, ")");
+            break;
+        case EXPR_MIN:
+        case EXPR_MAX:
+            fprintf (f, e->type == EXPR_MIN ? "min(" : "max(");
+            affine = _affine_fprint (f, l, w);
+            fprintf (f, ", ");
+            affine = _affine_fprint (f, r, w) && affine;
+            fprintf (f, ")");
+            break;
+        case EXPR_NEG:
+            fprintf (f, "(-");
+            affine = _affine_fprint (f, l, w);
+            fprintf (f, ")");
+            break;
+        case EXPR_ID:
+        {
+            /* The innermost binding, or else a parameter. */
+            const char * identifier = e->content.identifier;
+            size_t i = w->names.length;
+            while (i > 0 && strcmp (w->names.list[i - 1], identifier) != 0)
+                --i;
+
+            if (i > 0)
+                fprintf (f, "_l%zu", i - 1);
+            else if (string_list_index (w->a->parameters, identifier) >= 0)
+                fprintf (f, "%s", identifier);
+            else
+                affine = false;
+            break;
+        }
+        case EXPR_NUMBER:
+            fprintf (f, e->content.number < 0 ? "(%ld)" : "%ld",
+                    e->content.number);
+            break;
+        default:
+            affine = false;
+            break;
+    }
+
+    return affine;
+}
+
+bool _condition_fprint (FILE * f, const expression * e, bool negate,
+        const _walk * w)
+{
+    if (e == NULL)
+        return false;
+
+    /* The negations are pushed down to the comparisons. */
+    static const char * comparisons[][2] =
+    {
+        [EXPR_LT] = { " < ", " >= " },
+        [EXPR_GT] = { " > ", " <= " },
+        [EXPR_LE] = { " <= ", " > " },
+        [EXPR_GE] = { " >= ", " < " },
+    };
+
+    const expression * l = e->content.operands.left;
+    const expression * r = e->content.operands.right;
+    bool affine = true;
+    switch (e->type)
+    {
+        case EXPR_AND:
+        case EXPR_OR:
+            fprintf (f, "(");
+            affine = _condition_fprint (f, l, negate, w);
+            fprintf (f, (e->type == EXPR_AND) != negate ? " and " : " or ");
+            affine = _condition_fprint (f, r, negate, w) && affine;
+            fprintf (f, ")");
+            break;
+        case EXPR_NOT:
+            affine = _condition_fprint (f, l, ! negate, w);
+            break;
+        case EXPR_LT:
+        case EXPR_GT:
+        case EXPR_LE:
+        case EXPR_GE:
+            affine = _affine_fprint (f, l, w);
+            fprintf (f, "%s", comparisons[e->type][negate]);
+            affine = _affine_fprint (f, r, w) && affine;
+            break;
+        case EXPR_EQ:
+        case EXPR_NE:
+            /* a != b is (a < b or a > b). */
+            if ((e->type == EXPR_EQ) != negate)
+            {
+                affine = _affine_fprint (f, l, w);
+                fprintf (f, " = ");
+                affine = _affine_fprint (f, r, w) && affine;
+            }
+            else
+            {
+                fprintf (f, "(");
+                affine = _affine_fprint (f, l, w);
+                fprintf (f, " < ");
+                affine = _affine_fprint (f, r, w) && affine;
+                fprintf (f, " or ");
+                affine = _affine_fprint (f, l, w) && affine;
+                fprintf (f, " > ");
+                affine = _affine_fprint (f, r, w) && affine;
+                fprintf (f, ")");
+            }
+            break;
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+            fprintf (f, (e->type == EXPR_TRUE) != negate ? "0 = 0" : "1 = 0");
+            break;
+        default:
+            affine = false;
+            break;
+    }
+
+    return affine;
+}
+
+void _tuple_fprint (FILE * f, char prefix, size_t index, size_t depth)
+{
+    fprintf (f, "%c%zu[", prefix, index);
+    for (size_t i = 0; i < depth; ++i)
+        fprintf (f, "%s_l%zu", i > 0 ? ", " : "", i);
+    fprintf (f, "]");
+}
+
+void _bind (_walk * w, const char * identifier, const expression * e1,
+        const expression * e2)
+{
+    char * constraint;
+    size_t size;
+    FILE * f = open_memstream (& constraint, & size);
+    __forbid_value (f, NULL, "open_memstream", EX_OSERR);
+
+    /* lo <= _lK <= hi for loops, _lK = e for vals. */
+    size_t k = w->names.length;
+    bool affine = _affine_fprint (f, e1, w);
+    if (e2 != NULL)
+    {
+        fprintf (f, " <= _l%zu <= ", k);
+        affine = _affine_fprint (f, e2, w) && affine;
+    }
+    else
+        fprintf (f, " = _l%zu", k);
+    fclose (f);
+
+    w->a->affine = w->a->affine && affine;
+    string_list_append (& w->names, identifier);
+    string_list_append (& w->constraints, constraint);
+    free (constraint);
+}
+
+char * _statement (_walk * w, char prefix)
+{
+    analysis * a = w->a;
+    size_t index = a->statements++;
+    size_t depth = w->names.length;
+
+    char * tuple;
+    size_t tuple_size;
+    FILE * t = open_memstream (& tuple, & tuple_size);
+    __forbid_value (t, NULL, "open_memstream", EX_OSERR);
+    _tuple_fprint (t, prefix, index, depth);
+    fclose (t);
+
+    if (! a->affine)
+        return tuple;
+
+    char * parameters = string_list_to_string (a->parameters);
+    char * constraints;
+    size_t constraints_size;
+    FILE * c = open_memstream (& constraints, & constraints_size);
+    __forbid_value (c, NULL, "open_memstream", EX_OSERR);
+    for (size_t i = 0; i < w->constraints.length; ++i)
+        fprintf (c, "%s%s", i > 0 ? " and " : " : ", w->constraints.list[i]);
+    fclose (c);
+
+    char * string;
+    size_t size;
+    FILE * s = open_memstream (& string, & size);
+    __forbid_value (s, NULL, "open_memstream", EX_OSERR);
+    fprintf (s, "[%s] -> { %s%s }", a->parameters->length > 0 ? parameters
+            : "", tuple, constraints);
+    fclose (s);
+
+    isl_set * set = isl_set_read_from_str (a->ctx, string);
+    if (set == NULL)
+        a->affine = false;
+    else if (prefix == 'A')
+        a->asyncs = isl_union_set_add_set (a->asyncs, set);
+    else if (prefix == 'F')
+        a->finishes = isl_union_set_add_set (a->finishes, set);
+    else
+    {
+        /* The phase of a call is the innermost finish around it, or the
+         * program for asyncs, or the call itself.
+         */
+        const char * phase = w->phase != NULL ? w->phase
+            : w->async ? "P[]" : tuple;
+
+        char * map_string;
+        size_t map_size;
+        FILE * m = open_memstream (& map_string, & map_size);
+        __forbid_value (m, NULL, "open_memstream", EX_OSERR);
+        fprintf (m, "[%s] -> { %s -> %s%s }",
+                a->parameters->length > 0 ? parameters : "", tuple, phase,
+                constraints);
+        fclose (m);
+
+        isl_map * map = isl_map_read_from_str (a->ctx, map_string);
+        if (map != NULL)
+            a->phases = isl_union_map_add_map (a->phases, map);
+        free (map_string);
+
+        a->calls = isl_union_set_add_set (a->calls, set);
+    }
+
+    free (string);
+    free (constraints);
+    free (parameters);
+
+    return tuple;
+}
+
+void _walk_block (_walk * w, const instruction_list * list)
+{
+    size_t names = w->names.length;
+    size_t constraints = w->constraints.length;
+    for (const instruction_list * l = list; l != NULL; l = l->next)
+        _walk_instruction (w, l->element);
+    _truncate (& w->names, names);
+    _truncate (& w->constraints, constraints);
+}
+
+void _walk_instruction (_walk * w, const instruction * instr)
+{
+    if (instr == NULL || ! w->a->affine)
+        return;
+
+    switch (instr->type)
+    {
+        case INSTR_CALL:
+            if (w->calls)
+                free (_statement (w, 'S'));
+            break;
+        case INSTR_FOR:
+        {
+            size_t names = w->names.length;
+            size_t constraints = w->constraints.length;
+            _bind (w, instr->content.loop.identifier,
+                    instr->content.loop.left_boundary,
+                    instr->content.loop.right_boundary);
+            _walk_block (w, instr->content.loop.body);
+            _truncate (& w->names, names);
+            _truncate (& w->constraints, constraints);
+            break;
+        }
+        case INSTR_IF:
+        case INSTR_IF_ELSE:
+            for (int branch = 0; branch < (instr->content.branch.has_else
+                        ? 2 : 1); ++branch)
+            {
+                char * condition;
+                size_t size;
+                FILE * f = open_memstream (& condition, & size);
+                __forbid_value (f, NULL, "open_memstream", EX_OSERR);
+                bool affine = _condition_fprint (f,
+                        instr->content.branch.condition, branch == 1, w);
+                fclose (f);
+                w->a->affine = w->a->affine && affine;
+
+                /* A condition binds nothing: it only constrains. */
+                size_t constraints = w->constraints.length;
+                string_list_append (& w->constraints, condition);
+                free (condition);
+
+                _walk_block (w, branch == 0 ? instr->content.branch.true_body
+                        : instr->content.branch.false_body);
+                _truncate (& w->constraints, constraints);
+            }
+            break;
+        case INSTR_VAL:
+        case INSTR_VAR:
+            _bind (w, instr->content.bind.identifier,
+                    instr->content.bind.value, NULL);
+            break;
+        case INSTR_ASSIGN:
+            w->a->affine = false;
+            break;
+        case INSTR_FINISH:
+        case INSTR_CLOCKED_FINISH:
+        {
+            char * tuple = _statement (w, 'F');
+            char * enclosing = w->phase;
+            if (! w->async)
+                w->phase = tuple;
+            _walk_block (w, instr->content.block);
+            w->phase = enclosing;
+            free (tuple);
+            break;
+        }
+        case INSTR_ASYNC:
+        case INSTR_CLOCKED_ASYNC:
+        {
+            free (_statement (w, 'A'));
+            bool enclosing = w->async;
+            w->async = true;
+            _walk_block (w, instr->content.block);
+            w->async = enclosing;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+int _set_dates (isl_set * set, void * user)
+{
+    _region * r = (_region *) user;
+    analysis * a = r->a;
+
+    /* Calls of different regions may share their names. */
+    char name[32];
+    sprintf (name, "S%zu", a->statements++);
+    set = isl_set_set_tuple_name (set, name);
+
+    /* S[d, level] -> [region, d] */
+    isl_size n = isl_set_dim (set, isl_dim_set);
+    isl_map * phase = isl_map_reset_tuple_id (isl_map_project_out (
+                isl_set_identity (isl_set_copy (set)), isl_dim_out, 1,
+                (unsigned) n - 1), isl_dim_out);
+    phase = isl_map_insert_dims (phase, isl_dim_out, 0, 1);
+    phase = isl_map_fix_si (phase, isl_dim_out, 0, (int) r->index);
+
+    a->phases = isl_union_map_add_map (a->phases, phase);
+    a->calls = isl_union_set_add_set (a->calls, set);
+
+    return 0;
+}
+
+isl_set * _set_fix (isl_set * set, const analysis * a, const long int * values)
+{
+    for (size_t p = 0; p < a->parameters->length; ++p)
+    {
+        int position = isl_set_find_dim_by_name (set, isl_dim_param,
+                a->parameters->list[p]);
+        if (position >= 0)
+            set = isl_set_fix_val (set, isl_dim_param, (unsigned) position,
+                    isl_val_int_from_si (a->ctx, values[p]));
+    }
+
+    return set;
+}
+
+int _set_count (isl_set * set, void * user)
+{
+    _counts * c = (_counts *) user;
+
+    set = _set_fix (set, c->a, c->values);
+    isl_val * count = isl_set_count_val (set);
+    if (count != NULL)
+        c->count += isl_val_get_num_si (count);
+    isl_val_free (count);
+    isl_set_free (set);
+
+    return 0;
+}
+
+int _point_phase (isl_point * point, void * user)
+{
+    _counts * c = (_counts * ) user;
+
+    isl_union_set * instances = isl_union_set_apply (
+            isl_union_set_from_point (point),
+            isl_union_map_copy (c->instances));
+    long int count = _count (c->a, instances, c->values);
+    isl_union_set_free (instances);
+
+    ++c->count;
+    c->total += count;
+    if (count > c->widest)
+        c->widest = count;
+
+    return 0;
+}
+
+int _map_reverse (isl_map * map, void * user)
+{
+    _counts * c = (_counts *) user;
+
+    for (size_t p = 0; p < c->a->parameters->length; ++p)
+    {
+        int position = isl_map_find_dim_by_name (map, isl_dim_param,
+                c->a->parameters->list[p]);
+        if (position >= 0)
+            map = isl_map_fix_val (map, isl_dim_param, (unsigned) position,
+                    isl_val_int_from_si (c->a->ctx, c->values[p]));
+    }
+    c->instances = isl_union_map_add_map (c->instances,
+            isl_map_reverse (map));
+
+    return 0;
+}
+
+long int _count (const analysis * a, isl_union_set * u,
+        const long int * values)
+{
+    _counts c = { .a = a, .values = values, .count = 0, };
+    isl_union_set_foreach_set (u, _set_count, & c);
+    return c.count;
+}
+
+#ifdef NOCLOCK_BARVINOK
+int _sum (isl_pw_qpolynomial * pwqp, void * user)
+{
+    isl_pw_qpolynomial ** sum = (isl_pw_qpolynomial **) user;
+    * sum = * sum == NULL ? pwqp : isl_pw_qpolynomial_add (* sum, pwqp);
+    return 0;
+}
+
+int _max (isl_pw_qpolynomial_fold * pwf, void * user)
+{
+    isl_pw_qpolynomial_fold ** max = (isl_pw_qpolynomial_fold **) user;
+    * max = * max == NULL ? pwf : isl_pw_qpolynomial_fold_fold (* max, pwf);
+    return 0;
+}
+
+void _card_fprint (FILE * f, isl_union_set * u)
+{
+    /* The counts of all the statements live in the parameter space. */
+    isl_union_pw_qpolynomial * card = isl_union_set_card (u);
+    isl_pw_qpolynomial * sum = NULL;
+    isl_union_pw_qpolynomial_foreach_pw_qpolynomial (card, _sum, & sum);
+    isl_union_pw_qpolynomial_free (card);
+
+    if (sum == NULL)
+        fprintf (f, "0");
+    else
+    {
+        char * s = isl_pw_qpolynomial_to_str (sum);
+        fprintf (f, "%s", s);
+        free (s);
+        isl_pw_qpolynomial_free (sum);
+    }
+}
+
+void _widest_fprint (FILE * f, isl_union_map * phases)
+{
+    isl_union_pw_qpolynomial_fold * bound = isl_union_pw_qpolynomial_bound (
+            isl_union_map_card (isl_union_map_reverse (phases)), isl_fold_max,
+            NULL);
+    isl_pw_qpolynomial_fold * max = NULL;
+    isl_union_pw_qpolynomial_fold_foreach_pw_qpolynomial_fold (bound, _max,
+            & max);
+    isl_union_pw_qpolynomial_fold_free (bound);
+
+    if (max == NULL)
+        fprintf (f, "0");
+    else
+    {
+        char * s = isl_pw_qpolynomial_fold_to_str (max);
+        fprintf (f, "%s", s);
+        free (s);
+        isl_pw_qpolynomial_fold_free (max);
+    }
+}
+#endif
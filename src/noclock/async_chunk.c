@@ -0,0 +1,235 @@
+/**
+ * \file async_chunk.c
+ * \brief Async granularity control.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "noclock/async_chunk.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Strip-mine a loop whose body is a single async.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop (modified).
+ * \param chunk Number of iterations per async, or `0` for \p workers chunks.
+ * \param workers Number of chunks when \p chunk is `0`.
+ */
+static void _chunk_loop (instruction * loop, unsigned long int chunk,
+        unsigned long int workers);
+
+/**
+ * \brief Choose the chunk size of a loop from the profile.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop, whose body is a single async.
+ * \param workers Number of workers.
+ * \param model What is known of the run.
+ * \param chunk The chunk size, or `0` when the loop should run serially.
+ * \retval true if every statement of the async is profiled.
+ */
+static bool _profiled_chunk (const instruction * loop,
+        unsigned long int workers, const cost_model * model,
+        unsigned long int * chunk);
+
+/**
+ * \brief Run the iterations of a loop within the current activity.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop, whose body is a single async (modified).
+ */
+static void _serialize_loop (instruction * loop);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_chunk_asyncs (instruction_list * list,
+        unsigned long int chunk, unsigned long int workers,
+        const cost_model * model)
+{
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+            {
+                instruction_list_chunk_asyncs (instr->content.loop.body,
+                        chunk, workers, model);
+
+                instruction_list * body = instr->content.loop.body;
+                if (body == NULL || body->next != NULL
+                    || body->element->type != INSTR_ASYNC)
+                    break;
+
+                unsigned long int profiled;
+                if (! _profiled_chunk (instr, workers, model, & profiled))
+                    _chunk_loop (instr, chunk, workers);
+                else if (profiled == 0)
+                    _serialize_loop (instr);
+                else
+                    _chunk_loop (instr, profiled, workers);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                instruction_list_chunk_asyncs (
+                        instr->content.branch.true_body, chunk, workers, model);
+                if (instr->content.branch.has_else)
+                    instruction_list_chunk_asyncs (
+                            instr->content.branch.false_body, chunk, workers,
+                            model);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instruction_list_chunk_asyncs (instr->content.block, chunk,
+                        workers, model);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _chunk_loop (instruction * loop, unsigned long int chunk,
+        unsigned long int workers)
+{
+    expression * lo = loop->content.loop.left_boundary;
+    expression * hi = loop->content.loop.right_boundary;
+
+    /* Known trip counts which do not need chunks. */
+    bool known = expression_is_number (lo) && expression_is_number (hi);
+    long int trips = known
+        ? expression_get_number (hi) - expression_get_number (lo) + 1 : 0;
+
+    if (chunk == 1 || (chunk == 0 && (workers <= 1
+        || (known && trips <= (long int) workers))))
+        return;
+
+    char * identifier = loop->content.loop.identifier;
+    char * chunk_identifier = malloc (strlen (identifier) + 8);
+    __forbid_value (chunk_identifier, NULL, "malloc", EX_OSERR);
+    sprintf (chunk_identifier, "%s_chunk", identifier);
+
+    /* Either K iterations per chunk, or workers chunks of
+     * ((hi - lo) / workers + 1) iterations.
+     */
+    expression * size;
+    expression * last_chunk;
+    if (chunk != 0)
+    {
+        size = expression_from_number ((long int) chunk);
+        last_chunk = expression_div (
+                expression_sub (expression_copy (hi), expression_copy (lo)),
+                expression_from_number ((long int) chunk));
+    }
+    else
+    {
+        size = expression_add (expression_div (
+                    expression_sub (expression_copy (hi), expression_copy (lo)),
+                    expression_from_number ((long int) workers)),
+                expression_from_number (1));
+        last_chunk = expression_from_number ((long int) workers - 1);
+    }
+
+    expression * first = expression_add (expression_copy (lo),
+            expression_mult (expression_copy (size),
+                expression_from_identifier (chunk_identifier)));
+    expression * last = expression_min (expression_copy (hi),
+            expression_add (expression_copy (first),
+                expression_sub (size, expression_from_number (1))));
+
+    /* The async now runs the original loop over a single chunk. */
+    instruction * async = loop->content.loop.body->element;
+    instruction_list * chunk_loop = instruction_list_append (NULL,
+            instruction_for_loop (identifier, first, last,
+                async->content.block));
+    async->content.block = chunk_loop;
+
+    loop->content.loop.identifier = chunk_identifier;
+    loop->content.loop.left_boundary = expression_from_number (0);
+    loop->content.loop.right_boundary = last_chunk;
+
+    expression_free (lo);
+    expression_free (hi);
+}
+
+bool _profiled_chunk (const instruction * loop, unsigned long int workers,
+        const cost_model * model, unsigned long int * chunk)
+{
+    if (model == NULL || model->profile == NULL)
+        return false;
+
+    /* The work of a single iteration. */
+    const instruction * async = loop->content.loop.body->element;
+    cost c;
+    instruction_list_cost (async->content.block, model, & c);
+    if (! cost_is_profiled (& c))
+        return false;
+
+    * chunk = cost_grain (& c);
+
+    long int trips;
+    if (cost_model_iterations (model, loop, & trips))
+    {
+        /* Too little work for a single async. */
+        if (trips <= (long int) * chunk)
+            * chunk = 0;
+        /* Enough work for every worker, even with smaller chunks. */
+        else if (workers > 1 && trips / (long int) workers < (long int) * chunk)
+            * chunk = (unsigned long int) ((trips + (long int) workers - 1)
+                    / (long int) workers);
+    }
+
+    return true;
+}
+
+void _serialize_loop (instruction * loop)
+{
+    instruction_list * body = loop->content.loop.body;
+    instruction * async = body->element;
+
+    loop->content.loop.body = async->content.block;
+    async->content.block = NULL;
+
+    instruction_free (async);
+    free (body);
+}
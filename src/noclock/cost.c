@@ -0,0 +1,336 @@
+/**
+ * \file cost.c
+ * \brief Cost model of clocked and clock-free programs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/cost.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/** Iterations of the loops whose boundaries are unknown. */
+static const double _unknown_iterations = 32;
+
+/** Rough cost of a single instruction or expression node. */
+static const double _size_weight = 1;
+
+/** Rough cost of spawning an activity. */
+static const double _spawn_weight = 10;
+
+/** Rough cost of starting a thread. */
+static const double _thread_weight = 1000;
+
+/** Rough cost of waiting for a finish. */
+static const double _join_weight = 20;
+
+/** Rough cost of reaching an advance. */
+static const double _barrier_weight = 10;
+
+/** Nanoseconds per unit of cost. */
+static const double _work_weight = 0.1;
+
+/** How many spawns the work of an activity should cost at least. */
+static const double _grain = 100;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Count the nodes of an expression.
+ * \since version `1.1.0`
+ *
+ * \param e Expression.
+ * \return The number of nodes.
+ */
+static double _expression_size (const expression * e);
+
+/**
+ * \brief Evaluate an expression of the parameters.
+ * \since version `1.1.0`
+ *
+ * \param e Expression.
+ * \param v Known values.
+ * \param value Its value.
+ * \retval true if every identifier of the expression is known.
+ */
+static bool _evaluate (const expression * e, const cost_model * v,
+        long int * value);
+
+/**
+ * \brief Estimate the number of iterations of a loop.
+ * \since version `1.1.0`
+ *
+ * \param loop Loop.
+ * \param v Known values.
+ * \return The number of iterations.
+ */
+static double _iterations (const instruction * loop, const cost_model * v);
+
+/**
+ * \brief Add the cost of instructions run a number of times.
+ * \since version `1.1.0`
+ *
+ * \param list Instructions.
+ * \param times Number of times they run.
+ * \param v Known values.
+ * \param c Cost.
+ */
+static void _cost (const instruction_list * list, double times,
+        const cost_model * v, cost * c);
+
+////////////////////////////////////////////////////////////////////////////////
+// Estimation.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_cost (const instruction_list * list,
+        const cost_model * model, cost * c)
+{
+    * c = (cost) { .size = 0, };
+    _cost (list, 1, model, c);
+}
+
+bool cost_model_iterations (const cost_model * model,
+        const instruction * loop, long int * iterations)
+{
+    long int lo;
+    long int hi;
+    if (! _evaluate (loop->content.loop.left_boundary, model, & lo)
+        || ! _evaluate (loop->content.loop.right_boundary, model, & hi))
+        return false;
+
+    * iterations = hi < lo ? 0 : hi - lo + 1;
+    return true;
+}
+
+double cost_total (const cost * c)
+{
+    return c->size * _size_weight + c->spawns * _spawn_weight
+        + c->threads * _thread_weight + c->joins * _join_weight
+        + c->barriers * _barrier_weight + c->work * _work_weight;
+}
+
+bool cost_is_profiled (const cost * c)
+{
+    return c->work > 0 && c->unprofiled == 0;
+}
+
+unsigned long int cost_grain (const cost * c)
+{
+    double total = cost_total (c);
+    double runs = total > 0 ? _grain * _spawn_weight / total : 1;
+    if (runs <= 1)
+        return 1;
+
+    unsigned long int whole = (unsigned long int) runs;
+    return whole + (runs > whole);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+void cost_fprint (FILE * f, const cost * c)
+{
+    fprintf (f, "size %.0f, spawns %.0f, threads %.0f, joins %.0f,"
+            " barriers %.0f", c->size, c->spawns, c->threads, c->joins,
+            c->barriers);
+    if (cost_is_profiled (c))
+        fprintf (f, ", work %.0f ns", c->work);
+    fprintf (f, ": %.0f", cost_total (c));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+double _expression_size (const expression * e)
+{
+    if (e == NULL)
+        return 0;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+            return 1;
+        default:
+            return 1 + _expression_size (e->content.operands.left)
+                + _expression_size (e->content.operands.right);
+    }
+}
+
+bool _evaluate (const expression * e, const cost_model * v, long int * value)
+{
+    if (e == NULL)
+        return false;
+
+    long int l;
+    long int r;
+    switch (e->type)
+    {
+        case EXPR_NUMBER:
+            * value = e->content.number;
+            return true;
+        case EXPR_ID:
+            for (size_t p = 0; v->names != NULL && p < v->names->length; ++p)
+                if (strcmp (v->names->list[p], e->content.identifier) == 0)
+                {
+                    * value = v->values[p];
+                    return true;
+                }
+            return false;
+        case EXPR_NEG:
+            if (! _evaluate (e->content.operands.left, v, & l))
+                return false;
+            * value = -l;
+            return true;
+        case EXPR_ADD:
+        case EXPR_SUB:
+        case EXPR_MULT:
+        case EXPR_DIV:
+        case EXPR_MIN:
+        case EXPR_MAX:
+            if (! _evaluate (e->content.operands.left, v, & l)
+                || ! _evaluate (e->content.operands.right, v, & r))
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    switch (e->type)
+    {
+        case EXPR_ADD:
+            * value = l + r;
+            break;
+        case EXPR_SUB:
+            * value = l - r;
+            break;
+        case EXPR_MULT:
+            * value = l * r;
+            break;
+        case EXPR_DIV:
+            /* Floor division, as ISL does. */
+            if (r == 0)
+                return false;
+            * value = l / r - ((l % r != 0) && ((l < 0) != (r < 0)));
+            break;
+        case EXPR_MIN:
+            * value = l < r ? l : r;
+            break;
+        default:
+            * value = l > r ? l : r;
+            break;
+    }
+
+    return true;
+}
+
+double _iterations (const instruction * loop, const cost_model * v)
+{
+    long int iterations;
+    return cost_model_iterations (v, loop, & iterations)
+        ? (double) iterations : _unknown_iterations;
+}
+
+void _cost (const instruction_list * list, double times, const cost_model * v,
+        cost * c)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        c->size += 1;
+
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+            {
+                double time;
+                if (v->profile != NULL && profile_time (v->profile,
+                            instr->content.call.identifier, & time))
+                    c->work += times * time;
+                else
+                    c->unprofiled++;
+
+                for (const expression_list * a = instr->content.call.arguments;
+                        a != NULL; a = a->next)
+                    c->size += _expression_size (a->element);
+                break;
+            }
+            case INSTR_FOR:
+                c->size += _expression_size (instr->content.loop.left_boundary)
+                    + _expression_size (instr->content.loop.right_boundary);
+                _cost (instr->content.loop.body,
+                        times * _iterations (instr, v), v, c);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                c->size += _expression_size (instr->content.branch.condition);
+                _cost (instr->content.branch.true_body, times / 2, v, c);
+                if (instr->content.branch.has_else)
+                    _cost (instr->content.branch.false_body, times / 2, v, c);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                c->size += _expression_size (instr->content.bind.value);
+                break;
+            case INSTR_ADVANCE:
+                c->barriers += times;
+                break;
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+                c->joins += times;
+                _cost (instr->content.block, times, v, c);
+                break;
+            case INSTR_ASYNC:
+                c->spawns += times;
+                _cost (instr->content.block, times, v, c);
+                break;
+            case INSTR_CLOCKED_ASYNC:
+                c->threads += times;
+                _cost (instr->content.block, times, v, c);
+                break;
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,1033 @@
+/**
+ * \file emit.c
+ * \brief Code generation back ends.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/emit.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief State of the C and C++ back ends.
+ * \since version `1.1.0`
+ */
+typedef struct _c_context
+{
+    emit_format format;     /**< The back end. */
+    string_list scope;      /**< The locals bound so far. */
+    size_t finishes;        /**< Number of finishes declared so far. */
+    size_t finish;          /**< The innermost finish. */
+    size_t clocks;          /**< Number of clocks declared so far. */
+    size_t clock;           /**< The innermost clock, `0` if none. */
+    size_t activities;      /**< Number of activity functions so far. */
+    FILE * declarations;    /**< The closures of the activities. */
+    FILE * definitions;     /**< The functions of the activities. */
+} _c_context;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief The output format names.
+ * \since version `1.1.0`
+ */
+static const char * _emit_format_strings[] =
+{
+    [EMIT_X10]          = "x10",
+    [EMIT_C_OPENMP]     = "c-openmp",
+    [EMIT_CPP_CORO]     = "cpp-coro",
+    [EMIT_C_SPMD]       = "c-spmd",
+};
+
+/**
+ * \brief Headers of the C programs.
+ * \since version `1.1.0`
+ */
+static const char * _c_includes =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n";
+
+/**
+ * \brief Headers of the C++ programs.
+ * \since version `1.1.0`
+ */
+static const char * _cpp_includes =
+    "#include <cstdio>\n"
+    "#include <cstdlib>\n"
+    "\n"
+    "#include \"noclock_runtime.hpp\"\n";
+
+/**
+ * \brief Headers and runtime of the SPMD programs.
+ * \since version `1.1.0`
+ *
+ * The state of a clock packs the number of registered activities (high
+ * half) with the number of those which reached the end of the current phase
+ * (low half), so that advancing and dropping the clock are single atomic
+ * operations. The last one to arrive starts the next phase, while the others
+ * spin on the phase number.
+ */
+static const char * _spmd_includes =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <stdint.h>\n"
+    "#include <stdatomic.h>\n"
+    "#include <pthread.h>\n"
+    "#include <sched.h>\n"
+    "\n"
+    "typedef struct noclock_clock\n"
+    "{\n"
+    "    _Atomic uint64_t state;\n"
+    "    _Atomic unsigned long phase;\n"
+    "} noclock_clock;\n"
+    "\n"
+    "#define NOCLOCK_ONE ((uint64_t) 1 << 32)\n"
+    "#define NOCLOCK_ARRIVED(s) ((s) & (NOCLOCK_ONE - 1))\n"
+    "#define NOCLOCK_REGISTERED(s) ((s) >> 32)\n"
+    "\n"
+    "static void noclock_clock_init (noclock_clock * c)\n"
+    "{\n"
+    "    atomic_init (& c->state, NOCLOCK_ONE);\n"
+    "    atomic_init (& c->phase, 0);\n"
+    "}\n"
+    "\n"
+    "static void noclock_clock_register (noclock_clock * c)\n"
+    "{\n"
+    "    atomic_fetch_add (& c->state, NOCLOCK_ONE);\n"
+    "}\n"
+    "\n"
+    "static void noclock_clock_next (noclock_clock * c, uint64_t s)\n"
+    "{\n"
+    "    /* Every registered activity is waiting: nobody else touches the state. */\n"
+    "    atomic_store (& c->state, s - NOCLOCK_ARRIVED (s));\n"
+    "    atomic_fetch_add (& c->phase, 1);\n"
+    "}\n"
+    "\n"
+    "static void noclock_clock_advance (noclock_clock * c)\n"
+    "{\n"
+    "    unsigned long phase = atomic_load (& c->phase);\n"
+    "    uint64_t s = atomic_fetch_add (& c->state, 1) + 1;\n"
+    "    if (NOCLOCK_ARRIVED (s) == NOCLOCK_REGISTERED (s))\n"
+    "        noclock_clock_next (c, s);\n"
+    "    else\n"
+    "        for (unsigned int spin = 0; atomic_load (& c->phase) == phase; ++spin)\n"
+    "            if (spin > 64)\n"
+    "                sched_yield ();\n"
+    "}\n"
+    "\n"
+    "static void noclock_clock_drop (noclock_clock * c)\n"
+    "{\n"
+    "    uint64_t s = atomic_fetch_sub (& c->state, NOCLOCK_ONE) - NOCLOCK_ONE;\n"
+    "    if (NOCLOCK_ARRIVED (s) > 0 && NOCLOCK_ARRIVED (s) == NOCLOCK_REGISTERED (s))\n"
+    "        noclock_clock_next (c, s);\n"
+    "}\n"
+    "\n"
+    "typedef struct noclock_finish\n"
+    "{\n"
+    "    pthread_mutex_t lock;\n"
+    "    pthread_cond_t done;\n"
+    "    unsigned long pending;\n"
+    "} noclock_finish;\n"
+    "\n"
+    "static void noclock_finish_init (noclock_finish * f)\n"
+    "{\n"
+    "    pthread_mutex_init (& f->lock, NULL);\n"
+    "    pthread_cond_init (& f->done, NULL);\n"
+    "    f->pending = 0;\n"
+    "}\n"
+    "\n"
+    "static void noclock_finish_leave (noclock_finish * f)\n"
+    "{\n"
+    "    pthread_mutex_lock (& f->lock);\n"
+    "    if (--f->pending == 0)\n"
+    "        pthread_cond_broadcast (& f->done);\n"
+    "    pthread_mutex_unlock (& f->lock);\n"
+    "}\n"
+    "\n"
+    "static void noclock_finish_wait (noclock_finish * f)\n"
+    "{\n"
+    "    pthread_mutex_lock (& f->lock);\n"
+    "    while (f->pending > 0)\n"
+    "        pthread_cond_wait (& f->done, & f->lock);\n"
+    "    pthread_mutex_unlock (& f->lock);\n"
+    "    pthread_cond_destroy (& f->done);\n"
+    "    pthread_mutex_destroy (& f->lock);\n"
+    "}\n"
+    "\n"
+    "static void noclock_spawn (noclock_finish * f, void * (* run) (void *),\n"
+    "        void * closure)\n"
+    "{\n"
+    "    pthread_mutex_lock (& f->lock);\n"
+    "    f->pending++;\n"
+    "    pthread_mutex_unlock (& f->lock);\n"
+    "\n"
+    "    pthread_t thread;\n"
+    "    if (pthread_create (& thread, NULL, run, closure) != 0)\n"
+    "    {\n"
+    "        perror (\"pthread_create\");\n"
+    "        exit (EXIT_FAILURE);\n"
+    "    }\n"
+    "    pthread_detach (thread);\n"
+    "}\n";
+
+/**
+ * \brief Helpers of the C and C++ programs.
+ * \since version `1.1.0`
+ *
+ * The ISL ASTs divide with rounding towards negative infinity.
+ */
+static const char * _c_helpers =
+    "static inline long noclock_floord (long a, long b)\n"
+    "{\n"
+    "    long q = a / b;\n"
+    "    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;\n"
+    "}\n"
+    "\n"
+    "static inline long noclock_min (long a, long b)\n"
+    "{\n"
+    "    return a < b ? a : b;\n"
+    "}\n"
+    "\n"
+    "static inline long noclock_max (long a, long b)\n"
+    "{\n"
+    "    return a > b ? a : b;\n"
+    "}\n";
+
+/**
+ * \brief The C operators, or helper functions, of the expression types.
+ * \since version `1.1.0`
+ */
+static const char * _c_operators[] =
+{
+    [EXPR_OR]       = "||",
+    [EXPR_AND]      = "&&",
+    [EXPR_LT]       = "<",
+    [EXPR_GT]       = ">",
+    [EXPR_EQ]       = "==",
+    [EXPR_NE]       = "!=",
+    [EXPR_LE]       = "<=",
+    [EXPR_GE]       = ">=",
+    [EXPR_ADD]      = "+",
+    [EXPR_SUB]      = "-",
+    [EXPR_MULT]     = "*",
+    [EXPR_DIV]      = "noclock_floord",
+    [EXPR_MIN]      = "noclock_min",
+    [EXPR_MAX]      = "noclock_max",
+    [EXPR_NOT]      = "!",
+    [EXPR_NEG]      = "-",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Print an expression as C.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param e The expression.
+ */
+static void _c_expression_fprint (FILE * f, const expression * e);
+
+/**
+ * \brief Print the arguments of a call as C.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param arguments The arguments.
+ */
+static void _c_arguments_fprint (FILE * f, const expression_list * arguments);
+
+/**
+ * \brief Print the parameters of the program, or of an activity.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param names The names of the parameters.
+ * \param declare Whether to print them as declarations.
+ * \param first Whether they begin the list.
+ */
+static void _c_parameters_fprint (FILE * f, const string_list * names,
+        bool declare, bool first);
+
+/**
+ * \brief Declare the functions called by a program.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param list The program.
+ * \param declared The functions already declared (modified).
+ * \param linkage The storage class and linkage of the declarations.
+ */
+static void _c_declarations_fprint (FILE * f, const instruction_list * list,
+        string_list * declared, const char * linkage);
+
+/**
+ * \brief Print the beginning of a C or C++ program.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param list The program.
+ * \param includes The headers.
+ * \param linkage The storage class and linkage of the declarations.
+ */
+static void _c_prelude_fprint (FILE * f, const instruction_list * list,
+        const char * includes, const char * linkage);
+
+/**
+ * \brief Print the `main` function of a C or C++ program.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param parameters Parameters of the program.
+ * \param before Printed before the call to `noclock_program`.
+ * \param after Printed after the call to `noclock_program`.
+ */
+static void _c_driver_fprint (FILE * f, const string_list * parameters,
+        const char * before, const char * after);
+
+/**
+ * \brief Print instructions as C or C++.
+ * \since version `1.1.0`
+ *
+ * The locals they bind are dropped from the scope afterwards.
+ *
+ * \param f Output stream.
+ * \param list The instructions.
+ * \param context The state of the back end (modified).
+ */
+static void _c_instructions_fprint (FILE * f, const instruction_list * list,
+        _c_context * context);
+
+/**
+ * \brief Print a block of instructions as C or C++, within braces.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param list The instructions.
+ * \param context The state of the back end (modified).
+ */
+static void _c_block_fprint (FILE * f, const instruction_list * list,
+        _c_context * context);
+
+/**
+ * \brief Print a finish block as C++.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param list The body of the finish.
+ * \param context The state of the back end (modified).
+ */
+static void _cpp_finish_fprint (FILE * f, const instruction_list * list,
+        _c_context * context);
+
+/**
+ * \brief Print an async block as C++.
+ * \since version `1.1.0`
+ *
+ * The activity is a lambda coroutine taking the innermost finish and the
+ * locals by value: a coroutine must not refer to the captures of a lambda,
+ * which do not outlive the call.
+ *
+ * \param f Output stream.
+ * \param list The body of the async.
+ * \param context The state of the back end (modified).
+ */
+static void _cpp_async_fprint (FILE * f, const instruction_list * list,
+        _c_context * context);
+
+/**
+ * \brief Print a reference to an SPMD clock.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param clock The clock, `0` if none.
+ */
+static void _spmd_clock_fprint (FILE * f, size_t clock);
+
+/**
+ * \brief Print a finish block, clocked or not, as SPMD C.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param instr The finish.
+ * \param context The state of the back end (modified).
+ */
+static void _spmd_finish_fprint (FILE * f, const instruction * instr,
+        _c_context * context);
+
+/**
+ * \brief Print an async block, clocked or not, as SPMD C.
+ * \since version `1.1.0`
+ *
+ * The activity is spawned on a thread of its own, running a function which
+ * is printed with its closure to the streams of \p context.
+ *
+ * \param f Output stream.
+ * \param instr The async.
+ * \param context The state of the back end (modified).
+ */
+static void _spmd_async_fprint (FILE * f, const instruction * instr,
+        _c_context * context);
+
+/**
+ * \brief Print an instruction as C or C++.
+ * \since version `1.1.0`
+ *
+ * \param f Output stream.
+ * \param instr The instruction.
+ * \param context The state of the back end (modified).
+ */
+static void _c_instruction_fprint (FILE * f, const instruction * instr,
+        _c_context * context);
+
+////////////////////////////////////////////////////////////////////////////////
+// Output formats.
+////////////////////////////////////////////////////////////////////////////////
+
+emit_format emit_format_from_string (const char * name)
+{
+    for (emit_format format = 0; format < EMIT_UNKNOWN; ++format)
+        if (strcmp (name, _emit_format_strings[format]) == 0)
+            return format;
+
+    return EMIT_UNKNOWN;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Back ends.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_emit_c_openmp (FILE * f, const instruction_list * list,
+        const string_list * parameters)
+{
+    _c_prelude_fprint (f, list, _c_includes, "extern");
+
+    _c_context context = { .format = EMIT_C_OPENMP };
+    string_list_init (& context.scope);
+    for (size_t i = 0; i < parameters->length; ++i)
+        string_list_append (& context.scope, parameters->list[i]);
+
+    /* The program itself. */
+    fprintf (f, "static void noclock_program (");
+    if (parameters->length == 0)
+        fprintf (f, "void");
+    _c_parameters_fprint (f, parameters, true, true);
+    fprintf (f, ")\n{\n");
+
+    pretty_print_indent_increase ();
+    pretty_print_indent_fprint (f);
+    fprintf (f, "#pragma omp parallel\n");
+    pretty_print_indent_fprint (f);
+    fprintf (f, "#pragma omp single\n");
+    _c_block_fprint (f, list, & context);
+    pretty_print_indent_decrease ();
+
+    fprintf (f, "}\n\n");
+    string_list_clean (& context.scope);
+
+    _c_driver_fprint (f, parameters, "", "");
+}
+
+void instruction_list_emit_cpp_coro (FILE * f, const instruction_list * list,
+        const string_list * parameters)
+{
+    _c_prelude_fprint (f, list, _cpp_includes, "extern \"C\"");
+
+    _c_context context = { .format = EMIT_CPP_CORO };
+    string_list_init (& context.scope);
+    for (size_t i = 0; i < parameters->length; ++i)
+        string_list_append (& context.scope, parameters->list[i]);
+
+    /* The program itself: the root activity. */
+    fprintf (f, "static noclock::task noclock_program (");
+    _c_parameters_fprint (f, parameters, true, true);
+    fprintf (f, ")\n");
+    _cpp_finish_fprint (f, list, & context);
+    fprintf (f, "\n");
+    string_list_clean (& context.scope);
+
+    _c_driver_fprint (f, parameters, "noclock::run (", ")");
+}
+
+void instruction_list_emit_c_spmd (FILE * f, const instruction_list * list,
+        const string_list * parameters)
+{
+    _c_prelude_fprint (f, list, _spmd_includes, "extern");
+
+    _c_context context = { .format = EMIT_C_SPMD };
+    string_list_init (& context.scope);
+    for (size_t i = 0; i < parameters->length; ++i)
+        string_list_append (& context.scope, parameters->list[i]);
+
+    /* The activities are printed as they are met: buffer the program. */
+    char * declarations, * definitions, * program;
+    size_t size;
+    context.declarations = open_memstream (& declarations, & size);
+    context.definitions = open_memstream (& definitions, & size);
+    FILE * stream = open_memstream (& program, & size);
+    __forbid_value (context.declarations, NULL, "open_memstream", EX_OSERR);
+    __forbid_value (context.definitions, NULL, "open_memstream", EX_OSERR);
+    __forbid_value (stream, NULL, "open_memstream", EX_OSERR);
+
+    /* The program itself runs within an implicit finish. */
+    fprintf (stream, "static void noclock_program (");
+    if (parameters->length == 0)
+        fprintf (stream, "void");
+    _c_parameters_fprint (stream, parameters, true, true);
+    fprintf (stream, ")\n{\n");
+
+    pretty_print_indent_increase ();
+    pretty_print_indent_fprint (stream);
+    fprintf (stream, "noclock_finish noclock_f0[1];\n");
+    pretty_print_indent_fprint (stream);
+    fprintf (stream, "noclock_finish_init (noclock_f0);\n");
+    context.finishes = 1;
+    _c_instructions_fprint (stream, list, & context);
+    pretty_print_indent_fprint (stream);
+    fprintf (stream, "noclock_finish_wait (noclock_f0);\n");
+    pretty_print_indent_decrease ();
+
+    fprintf (stream, "}\n\n");
+    string_list_clean (& context.scope);
+
+    fclose (context.declarations);
+    fclose (context.definitions);
+    fclose (stream);
+    fprintf (f, "%s%s%s", declarations, definitions, program);
+    free (declarations);
+    free (definitions);
+    free (program);
+
+    _c_driver_fprint (f, parameters, "", "");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _c_expression_fprint (FILE * f, const expression * e)
+{
+    if (e == NULL)
+        return;
+
+    expression_type t = e->type;
+    switch (t)
+    {
+        case EXPR_OR:
+        case EXPR_AND:
+        case EXPR_LT:
+        case EXPR_GT:
+        case EXPR_EQ:
+        case EXPR_NE:
+        case EXPR_LE:
+        case EXPR_GE:
+        case EXPR_ADD:
+        case EXPR_SUB:
+        case EXPR_MULT:
+            fprintf (f, "(");
+            _c_expression_fprint (f, expression_get_left (e));
+            fprintf (f, " %s ", _c_operators[t]);
+            _c_expression_fprint (f, expression_get_right (e));
+            fprintf (f, ")");
+            break;
+        case EXPR_DIV:
+        case EXPR_MIN:
+        case EXPR_MAX:
+            fprintf (f, "%s (", _c_operators[t]);
+            _c_expression_fprint (f, expression_get_left (e));
+            fprintf (f, ", ");
+            _c_expression_fprint (f, expression_get_right (e));
+            fprintf (f, ")");
+            break;
+        case EXPR_NOT:
+        case EXPR_NEG:
+            /* Parenthesized, lest "- -1" becomes "--1". */
+            fprintf (f, "%s(", _c_operators[t]);
+            _c_expression_fprint (f, expression_get_left (e));
+            fprintf (f, ")");
+            break;
+        case EXPR_ID:
+            fprintf (f, "%s", expression_get_identifier (e));
+            break;
+        case EXPR_NUMBER:
+            fprintf (f, "%ld", expression_get_number (e));
+            break;
+        case EXPR_TRUE:
+            fprintf (f, "1");
+            break;
+        case EXPR_FALSE:
+            fprintf (f, "0");
+            break;
+        default:
+            break;
+    }
+}
+
+void _c_arguments_fprint (FILE * f, const expression_list * arguments)
+{
+    for (const expression_list * a = arguments; a != NULL; a = a->next)
+    {
+        _c_expression_fprint (f, a->element);
+        if (a->next != NULL)
+            fprintf (f, ", ");
+    }
+}
+
+void _c_parameters_fprint (FILE * f, const string_list * names,
+        bool declare, bool first)
+{
+    for (size_t i = 0; i < names->length; ++i)
+        fprintf (f, "%s%s%s", first && i == 0 ? "" : ", ",
+                declare ? "long " : "", names->list[i]);
+}
+
+void _c_declarations_fprint (FILE * f, const instruction_list * list,
+        string_list * declared, const char * linkage)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+            {
+                const char * identifier = instr->content.call.identifier;
+                if (string_list_index (declared, identifier) != -1)
+                    break;
+                string_list_append (declared, identifier);
+
+                fprintf (f, "%s void %s (", linkage, identifier);
+                const expression_list * a = instr->content.call.arguments;
+                if (a == NULL)
+                    fprintf (f, "void");
+                for (; a != NULL; a = a->next)
+                    fprintf (f, "long%s", a->next != NULL ? ", " : "");
+                fprintf (f, ");\n");
+                break;
+            }
+            case INSTR_FOR:
+                _c_declarations_fprint (f, instr->content.loop.body, declared,
+                        linkage);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _c_declarations_fprint (f, instr->content.branch.true_body,
+                        declared, linkage);
+                if (instr->content.branch.has_else)
+                    _c_declarations_fprint (f,
+                            instr->content.branch.false_body, declared,
+                            linkage);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _c_declarations_fprint (f, instr->content.block, declared,
+                        linkage);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void _c_prelude_fprint (FILE * f, const instruction_list * list,
+        const char * includes, const char * linkage)
+{
+    fprintf (f, "%s\n%s\n", includes, _c_helpers);
+
+    string_list declared;
+    string_list_init (& declared);
+    _c_declarations_fprint (f, list, & declared, linkage);
+    if (declared.length > 0)
+        fprintf (f, "\n");
+    string_list_clean (& declared);
+}
+
+void _c_driver_fprint (FILE * f, const string_list * parameters,
+        const char * before, const char * after)
+{
+    fprintf (f, "int main (int argc, char ** argv)\n{\n");
+    fprintf (f, "    if (argc != %zu)\n    {\n", parameters->length + 1);
+    fprintf (f, "        fprintf (stderr, \"Usage: %%s");
+    for (size_t i = 0; i < parameters->length; ++i)
+        fprintf (f, " <%s>", parameters->list[i]);
+    fprintf (f, "\\n\", argv[0]);\n");
+    fprintf (f, "        return EXIT_FAILURE;\n    }\n\n");
+
+    for (size_t i = 0; i < parameters->length; ++i)
+        fprintf (f, "    long %s = strtol (argv[%zu], NULL, 10);\n",
+                parameters->list[i], i + 1);
+    if (parameters->length > 0)
+        fprintf (f, "\n");
+
+    fprintf (f, "    %snoclock_program (", before);
+    _c_parameters_fprint (f, parameters, false, true);
+    fprintf (f, ")%s;\n\n    return EXIT_SUCCESS;\n}\n", after);
+}
+
+void _c_instructions_fprint (FILE * f, const instruction_list * list,
+        _c_context * context)
+{
+    size_t scope = context->scope.length;
+
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+        _c_instruction_fprint (f, current->element, context);
+
+    /* Drop the locals of the block. */
+    while (context->scope.length > scope)
+        free (context->scope.list[--context->scope.length]);
+}
+
+void _c_block_fprint (FILE * f, const instruction_list * list,
+        _c_context * context)
+{
+    pretty_print_indent_fprint (f);
+    fprintf (f, "{\n");
+
+    pretty_print_indent_increase ();
+    _c_instructions_fprint (f, list, context);
+    pretty_print_indent_decrease ();
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "}\n");
+}
+
+void _cpp_finish_fprint (FILE * f, const instruction_list * list,
+        _c_context * context)
+{
+    size_t enclosing = context->finish;
+    context->finish = context->finishes++;
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "{\n");
+    pretty_print_indent_increase ();
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock::finish f%zu;\n", context->finish);
+    _c_instructions_fprint (f, list, context);
+    pretty_print_indent_fprint (f);
+    fprintf (f, "co_await f%zu;\n", context->finish);
+
+    pretty_print_indent_decrease ();
+    pretty_print_indent_fprint (f);
+    fprintf (f, "}\n");
+
+    context->finish = enclosing;
+}
+
+void _cpp_async_fprint (FILE * f, const instruction_list * list,
+        _c_context * context)
+{
+    size_t finish = context->finish;
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "f%zu.spawn ([] (noclock::finish & f%zu", finish, finish);
+    _c_parameters_fprint (f, & context->scope, true, false);
+    fprintf (f, ") -> noclock::task\n");
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "{\n");
+    pretty_print_indent_increase ();
+    _c_instructions_fprint (f, list, context);
+    pretty_print_indent_fprint (f);
+    fprintf (f, "co_return;\n");
+    pretty_print_indent_decrease ();
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "} (f%zu", finish);
+    _c_parameters_fprint (f, & context->scope, false, false);
+    fprintf (f, "));\n");
+}
+
+void _spmd_clock_fprint (FILE * f, size_t clock)
+{
+    if (clock == 0)
+        fprintf (f, "NULL");
+    else
+        fprintf (f, "noclock_c%zu", clock);
+}
+
+void _spmd_finish_fprint (FILE * f, const instruction * instr,
+        _c_context * context)
+{
+    bool clocked = instr->type == INSTR_CLOCKED_FINISH;
+    size_t enclosing_finish = context->finish;
+    size_t enclosing_clock = context->clock;
+    context->finish = context->finishes++;
+    if (clocked)
+        context->clock = ++context->clocks;
+
+    pretty_print_indent_fprint (f);
+    fprintf (f, "{\n");
+    pretty_print_indent_increase ();
+
+    if (clocked)
+    {
+        pretty_print_indent_fprint (f);
+        fprintf (f, "noclock_clock noclock_c%zu[1];\n", context->clock);
+        pretty_print_indent_fprint (f);
+        fprintf (f, "noclock_clock_init (noclock_c%zu);\n", context->clock);
+    }
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock_finish noclock_f%zu[1];\n", context->finish);
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock_finish_init (noclock_f%zu);\n", context->finish);
+
+    _c_instructions_fprint (f, instr->content.block, context);
+
+    /* The body of a clocked finish is registered until it ends. */
+    if (clocked)
+    {
+        pretty_print_indent_fprint (f);
+        fprintf (f, "noclock_clock_drop (noclock_c%zu);\n", context->clock);
+    }
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock_finish_wait (noclock_f%zu);\n", context->finish);
+
+    pretty_print_indent_decrease ();
+    pretty_print_indent_fprint (f);
+    fprintf (f, "}\n");
+
+    context->finish = enclosing_finish;
+    context->clock = enclosing_clock;
+}
+
+void _spmd_async_fprint (FILE * f, const instruction * instr,
+        _c_context * context)
+{
+    size_t activity = ++context->activities;
+    size_t enclosing_clock = context->clock;
+    if (instr->type != INSTR_CLOCKED_ASYNC)
+        context->clock = 0;
+
+    /* The closure: the locals, by value. */
+    FILE * d = context->declarations;
+    fprintf (d, "struct noclock_activity_%zu\n{\n", activity);
+    fprintf (d, "    noclock_clock * clock;\n");
+    fprintf (d, "    noclock_finish * finish;\n");
+    for (size_t i = 0; i < context->scope.length; ++i)
+        fprintf (d, "    long %s;\n", context->scope.list[i]);
+    fprintf (d, "};\n\n");
+    fprintf (d, "static void * noclock_activity_%zu (void * noclock_argument);"
+            "\n\n", activity);
+
+    /* The spawn. */
+    pretty_print_indent_fprint (f);
+    fprintf (f, "{\n");
+    pretty_print_indent_increase ();
+    pretty_print_indent_fprint (f);
+    fprintf (f, "struct noclock_activity_%zu * noclock_a = "
+            "malloc (sizeof * noclock_a);\n", activity);
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock_a->clock = ");
+    _spmd_clock_fprint (f, context->clock);
+    fprintf (f, ";\n");
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock_a->finish = noclock_f%zu;\n", context->finish);
+    for (size_t i = 0; i < context->scope.length; ++i)
+    {
+        pretty_print_indent_fprint (f);
+        fprintf (f, "noclock_a->%s = %s;\n", context->scope.list[i],
+                context->scope.list[i]);
+    }
+    if (context->clock != 0)
+    {
+        pretty_print_indent_fprint (f);
+        fprintf (f, "noclock_clock_register (noclock_c%zu);\n",
+                context->clock);
+    }
+    pretty_print_indent_fprint (f);
+    fprintf (f, "noclock_spawn (noclock_f%zu, noclock_activity_%zu, "
+            "noclock_a);\n", context->finish, activity);
+    pretty_print_indent_decrease ();
+    pretty_print_indent_fprint (f);
+    fprintf (f, "}\n");
+
+    /* The function, printed from the top level. */
+    char * function;
+    size_t size;
+    FILE * g = open_memstream (& function, & size);
+    __forbid_value (g, NULL, "open_memstream", EX_OSERR);
+
+    size_t level = pretty_print_indent_level ();
+    for (size_t i = 0; i < level; ++i)
+        pretty_print_indent_decrease ();
+
+    fprintf (g, "void * noclock_activity_%zu (void * noclock_argument)\n{\n",
+            activity);
+    fprintf (g, "    struct noclock_activity_%zu * noclock_a = "
+            "noclock_argument;\n", activity);
+    if (context->clock != 0)
+        fprintf (g, "    noclock_clock * noclock_c%zu = noclock_a->clock;\n",
+                context->clock);
+    fprintf (g, "    noclock_finish * noclock_f%zu = noclock_a->finish;\n",
+            context->finish);
+    for (size_t i = 0; i < context->scope.length; ++i)
+        fprintf (g, "    long %s = noclock_a->%s;\n", context->scope.list[i],
+                context->scope.list[i]);
+    fprintf (g, "    free (noclock_a);\n\n");
+
+    pretty_print_indent_increase ();
+    _c_instructions_fprint (g, instr->content.block, context);
+    pretty_print_indent_decrease ();
+
+    fprintf (g, "\n");
+    if (context->clock != 0)
+        fprintf (g, "    noclock_clock_drop (noclock_c%zu);\n",
+                context->clock);
+    fprintf (g, "    noclock_finish_leave (noclock_f%zu);\n", context->finish);
+    fprintf (g, "    return NULL;\n}\n\n");
+
+    for (size_t i = 0; i < level; ++i)
+        pretty_print_indent_increase ();
+
+    fclose (g);
+    fprintf (context->definitions, "%s", function);
+    free (function);
+
+    context->clock = enclosing_clock;
+}
+
+void _c_instruction_fprint (FILE * f, const instruction * instr,
+        _c_context * context)
+{
+    if (instr == NULL)
+        return;
+
+    switch (instr->type)
+    {
+        case INSTR_CALL:
+            pretty_print_indent_fprint (f);
+            fprintf (f, "%s (", instr->content.call.identifier);
+            _c_arguments_fprint (f, instr->content.call.arguments);
+            fprintf (f, ");\n");
+            break;
+        case INSTR_FOR:
+        {
+            const char * identifier = instr->content.loop.identifier;
+            pretty_print_indent_fprint (f);
+            fprintf (f, "for (long %s = ", identifier);
+            _c_expression_fprint (f, instr->content.loop.left_boundary);
+            fprintf (f, "; %s <= ", identifier);
+            _c_expression_fprint (f, instr->content.loop.right_boundary);
+            fprintf (f, "; ++%s)\n", identifier);
+
+            /* The iterator is bound within the body only. */
+            size_t scope = context->scope.length;
+            string_list_append (& context->scope, identifier);
+            _c_block_fprint (f, instr->content.loop.body, context);
+            free (context->scope.list[scope]);
+            context->scope.length = scope;
+            break;
+        }
+        case INSTR_IF:
+        case INSTR_IF_ELSE:
+            pretty_print_indent_fprint (f);
+            fprintf (f, "if (");
+            _c_expression_fprint (f, instr->content.branch.condition);
+            fprintf (f, ")\n");
+            _c_block_fprint (f, instr->content.branch.true_body, context);
+            if (instr->content.branch.has_else)
+            {
+                pretty_print_indent_fprint (f);
+                fprintf (f, "else\n");
+                _c_block_fprint (f, instr->content.branch.false_body, context);
+            }
+            break;
+        case INSTR_VAL:
+        case INSTR_VAR:
+        case INSTR_ASSIGN:
+            pretty_print_indent_fprint (f);
+            if (instr->type == INSTR_VAL)
+                fprintf (f, "const long ");
+            else if (instr->type == INSTR_VAR)
+                fprintf (f, "long ");
+            fprintf (f, "%s = ", instr->content.bind.identifier);
+            _c_expression_fprint (f, instr->content.bind.value);
+            fprintf (f, ";\n");
+
+            if (instr->type != INSTR_ASSIGN)
+                string_list_append (& context->scope,
+                        instr->content.bind.identifier);
+            break;
+        case INSTR_ADVANCE:
+            if (context->format == EMIT_C_SPMD && context->clock != 0)
+            {
+                pretty_print_indent_fprint (f);
+                fprintf (f, "noclock_clock_advance (noclock_c%zu);\n",
+                        context->clock);
+            }
+            break;
+        case INSTR_FINISH:
+        case INSTR_CLOCKED_FINISH:
+            if (context->format == EMIT_C_SPMD)
+            {
+                _spmd_finish_fprint (f, instr, context);
+                break;
+            }
+            if (context->format == EMIT_CPP_CORO)
+            {
+                _cpp_finish_fprint (f, instr->content.block, context);
+                break;
+            }
+            pretty_print_indent_fprint (f);
+            fprintf (f, "#pragma omp taskgroup\n");
+            _c_block_fprint (f, instr->content.block, context);
+            break;
+        case INSTR_ASYNC:
+        case INSTR_CLOCKED_ASYNC:
+            if (context->format == EMIT_C_SPMD)
+            {
+                _spmd_async_fprint (f, instr, context);
+                break;
+            }
+            if (context->format == EMIT_CPP_CORO)
+            {
+                _cpp_async_fprint (f, instr->content.block, context);
+                break;
+            }
+            pretty_print_indent_fprint (f);
+            fprintf (f, "#pragma omp task\n");
+            _c_block_fprint (f, instr->content.block, context);
+            break;
+        default:
+            break;
+    }
+}
@@ -71,7 +71,7 @@ static const char * expression_type_strings[] =
     [EXPR_ADD]      = "+",
     [EXPR_SUB]      = "-",
     [EXPR_MULT]     = "*",
-    [EXPR_DIV]      = "/",
+    [EXPR_DIV]      = "floord",
     [EXPR_MIN]      = "min",
     [EXPR_MAX]      = "max",
 
@@ -518,6 +518,51 @@ bool expression_is_false (const expression * const e)
     return e->type == EXPR_FALSE;
 }
 
+bool expression_equal (const expression * a, const expression * b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    if (a->type != b->type)
+        return false;
+
+    switch (a->type)
+    {
+        case EXPR_ID:
+            return ! strcmp (a->content.identifier, b->content.identifier);
+        case EXPR_NUMBER:
+            return a->content.number == b->content.number;
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+        case EXPR_UNKNOWN:
+            return true;
+        default:
+            return expression_equal (a->content.operands.left,
+                        b->content.operands.left)
+                && expression_equal (a->content.operands.right,
+                        b->content.operands.right);
+    }
+}
+
+bool expression_uses (const expression * e, const char * identifier)
+{
+    if (e == NULL)
+        return false;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+            return ! strcmp (e->content.identifier, identifier);
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+        case EXPR_UNKNOWN:
+            return false;
+        default:
+            return expression_uses (e->content.operands.left, identifier)
+                || expression_uses (e->content.operands.right, identifier);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Operations.
 ////////////////////////////////////////////////////////////////////////////////
@@ -629,7 +674,9 @@ expression * expression_div (expression * a, expression * b)
         result = keep_first (a, b);
     else if (expression_is_one (b))
         result = keep_first (a, b);
-    else if (expression_is_number (a) && expression_is_number (b))
+    /* A division by zero is left for run time to report. */
+    else if (expression_is_number (a) && expression_is_number (b)
+            && ! expression_is_zero (b))
         result = both_numbers (a, b, EXPR_DIV);
     else
     {
@@ -785,6 +832,35 @@ expression * expression_ne (expression * a, expression * b)
     return result;
 }
 
+expression * expression_substitute (const expression * e,
+        const char * identifier, const expression * value)
+{
+    if (e == NULL)
+        return NULL;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+            return ! strcmp (e->content.identifier, identifier)
+                ? expression_copy (value) : expression_copy (e);
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+        case EXPR_UNKNOWN:
+            return expression_copy (e);
+        default:
+        {
+            expression * result = expression_alloc ();
+            result->type = e->type;
+            result->content.operands.left = expression_substitute (
+                    e->content.operands.left, identifier, value);
+            result->content.operands.right = expression_substitute (
+                    e->content.operands.right, identifier, value);
+            return result;
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Input/Output.
 ////////////////////////////////////////////////////////////////////////////////
@@ -839,7 +915,6 @@ char * expression_to_string (const expression * e)
         case EXPR_ADD:
         case EXPR_SUB:
         case EXPR_MULT:
-        case EXPR_DIV:
             left = expression_to_string (expression_get_left (e));
             right = expression_to_string (expression_get_right (e));
 
@@ -853,6 +928,10 @@ char * expression_to_string (const expression * e)
 
             break;
 
+        /* Divisions round towards negative infinity, as ISL's floord (and
+         * unlike X10's /).
+         */
+        case EXPR_DIV:
         case EXPR_MIN:
         case EXPR_MAX:
             left = expression_to_string (expression_get_left (e));
@@ -939,13 +1018,13 @@ char * expression_to_string (const expression * e)
 
 expression * keep_first (expression * keep, expression * ditch)
 {
-    free (ditch);
+    expression_free (ditch);
     return keep;
 }
 
 expression * ditch_first (expression * ditch, expression * keep)
 {
-    free (ditch);
+    expression_free (ditch);
     return keep;
 }
 
@@ -964,8 +1043,14 @@ static inline expression * both_numbers (expression * a, expression * b,
             a->content.number *= b->content.number;
             break;
         case EXPR_DIV:
-            a->content.number /= b->content.number;
+        {
+            /* Rounded towards negative infinity, as in the ISL ASTs. */
+            long int n = a->content.number;
+            long int d = b->content.number;
+            long int q = n / d;
+            a->content.number = n % d != 0 && (n < 0) != (d < 0) ? q - 1 : q;
             break;
+        }
         case EXPR_MIN:
             a->content.number = a->content.number < b->content.number ?
                 a->content.number : b->content.number;
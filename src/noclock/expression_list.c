@@ -34,34 +34,6 @@
 
 #include "noclock/expression_list.h"
 
-////////////////////////////////////////////////////////////////////////////////
-// Static functions declarations.
-////////////////////////////////////////////////////////////////////////////////
-
-/**
- * \brief Delete coordinates from an expression list.
- * \since version `1.0.0`
- * \param list The expression list where coordinates must be deleted.
- * \return The resulting list.
- */
-static expression_list * expression_list_strip_coords (expression_list * list);
-
-/**
- * \brief Delete the first expression from an expression list.
- * \since version `1.0.0`
- * \param list The expression list where the first expression must be deleted.
- * \return The resulting list.
- */
-static expression_list * expression_list_strip_first (expression_list * list);
-
-/**
- * \brief Delete expressions that refer to keywords.
- * \since version `1.0.0`
- * \param list The expression list where the keywords must be deleted.
- * \return The resulting list.
- */
-static expression_list * expression_list_strip_keywords (expression_list * list);
-
 ////////////////////////////////////////////////////////////////////////////////
 // Allocation, initialization, copy, cleaning, free.
 ////////////////////////////////////////////////////////////////////////////////
@@ -185,21 +157,6 @@ void expression_list_free (expression_list * list)
     }
 }
 
-expression_list * expression_list_strip
-        (expression_list * list)
-{
-    /* Removing the coordinates must be the very first operation! */
-    list = expression_list_strip_coords (list);
-
-    /* It is not safe to execute these operations in any order.
-     * Strip keywords before deleting the very first argument!
-     */
-    list = expression_list_strip_keywords (list);
-    list = expression_list_strip_first (list);
-
-    return list;
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 // Input/Output.
 ////////////////////////////////////////////////////////////////////////////////
@@ -230,7 +187,7 @@ char * expression_list_to_string (
     __forbid_value (buffer, NULL, "malloc", EX_OSERR);
     buffer[0] = buffer[1] = buffer[2] = buffer[3] = '\0';
 
-    for (const expression_list * current = list; ; )
+    for (const expression_list * current = list; current != NULL; )
     {
         char * current_str = expression_to_string (current->element);
         current = current->next;
@@ -253,66 +210,3 @@ char * expression_list_to_string (
 
     return buffer;
 }
-
-////////////////////////////////////////////////////////////////////////////////
-// Static functions definitions.
-////////////////////////////////////////////////////////////////////////////////
-
-expression_list * expression_list_strip_coords (expression_list * list)
-{
-    /* We know that when expression lists that contain coordinates are
-     * built, the coordinates are placed at even indexes (starting at 0):
-     * this function shall delete expressions at even indexes (when the function
-     * starts!) and keep expressions at odd indexes.
-     */
-
-    expression_list * current = list;
-    while (current != NULL)
-    {
-        expression_list * next = NULL;
-        if (current->next != NULL)
-        {
-            next = current->next->next;
-            expression_free (current->next->element);
-            free (current->next);
-        }
-        current->next = next;
-        current = current->next;
-    }
-
-    return list;
-}
-
-expression_list * expression_list_strip_first (expression_list * list)
-{
-    expression_list * next = list->next;
-    expression_free (list->element);
-    free (list);
-    return next;
-}
-
-expression_list * expression_list_strip_keywords (expression_list * list)
-{
-    expression_list * current = list;
-    while (current != NULL)
-    {
-        expression_list * next = current->next;
-
-        while (next != NULL && next->element->type == EXPR_ID)
-        {
-            char * id = next->element->content.identifier;
-            if (strcmp (id, "f") == 0 || strcmp (id, "a") == 0)
-            {
-                current->next = next->next;
-                expression_free (next->element);
-                free (next);
-                next = current->next;
-            }
-            else
-                next = NULL;
-        }
-        current = current->next;
-    }
-
-    return list;
-}
@@ -0,0 +1,378 @@
+/**
+ * \file fast_path.c
+ * \brief Clock removal without ISL.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "noclock/fast_path.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Check whether the clocks of a program order nothing.
+ * \since version `1.1.0`
+ *
+ * \param list Input AST.
+ * \return Whether every clocked finish runs a single clocked activity.
+ */
+static bool _trivial_clocks (const instruction_list * list);
+
+/**
+ * \brief Count the clocked asyncs spawned by the body of a clocked finish.
+ * \since version `1.1.0`
+ *
+ * \param list Body of the clocked finish.
+ * \param looped Whether \p list is inside a loop.
+ * \param parent_advances Set if the parent activity advances or calls.
+ * \return The number of clocked asyncs, `2` meaning "more than one", or `-1`
+ * if a clocked finish is nested.
+ */
+static int _clocked_activities (const instruction_list * list, bool looped,
+        bool * parent_advances);
+
+/**
+ * \brief Copy an AST, turning clocked constructs into plain ones.
+ * \since version `1.1.0`
+ *
+ * \param list Input AST.
+ * \return The copy, without any advance.
+ */
+static instruction_list * _unclock (const instruction_list * list);
+
+/**
+ * \brief Fuse a rectangular lockstep nest.
+ * \since version `1.1.0`
+ *
+ * \param program Input program.
+ * \return The program without clocks, or `NULL` if it is not such a nest.
+ */
+static instruction_list * _lockstep (const instruction_list * program);
+
+/**
+ * \brief Wrap an instruction in a list.
+ * \since version `1.1.0`
+ *
+ * \param instr Instruction.
+ * \return A list holding only \p instr.
+ */
+static instruction_list * _single (instruction * instr);
+
+/**
+ * \brief Get the only instruction of a list.
+ * \since version `1.1.0`
+ *
+ * \param list List.
+ * \param t Expected type.
+ * \return The instruction, or `NULL` if the list holds more than one
+ * instruction or if its type is not \p t.
+ */
+static instruction * _only (const instruction_list * list, instruction_type t);
+
+////////////////////////////////////////////////////////////////////////////////
+// Fast path.
+////////////////////////////////////////////////////////////////////////////////
+
+instruction_list * fast_path (const instruction_list * program)
+{
+    if (program == NULL)
+        return NULL;
+
+    if (_trivial_clocks (program))
+        return _unclock (program);
+
+    return _lockstep (program);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+bool _trivial_clocks (const instruction_list * list)
+{
+    bool trivial = true;
+
+    for (const instruction_list * current = list; current != NULL && trivial;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                trivial = _trivial_clocks (instr->content.loop.body);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                trivial = _trivial_clocks (instr->content.branch.true_body)
+                    && (! instr->content.branch.has_else
+                        || _trivial_clocks (instr->content.branch.false_body));
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_ASYNC:
+                trivial = _trivial_clocks (instr->content.block);
+                break;
+            case INSTR_CLOCKED_FINISH:
+            {
+                /* A single clocked activity only synchronizes with itself,
+                 * unless the parent also runs or advances next to it.
+                 */
+                bool parent_advances = false;
+                int activities = _clocked_activities (instr->content.block,
+                        false, & parent_advances);
+                trivial = activities == 0
+                    || (activities == 1 && ! parent_advances);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return trivial;
+}
+
+int _clocked_activities (const instruction_list * list, bool looped,
+        bool * parent_advances)
+{
+    int activities = 0;
+
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        int n = 0;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+            case INSTR_ADVANCE:
+                * parent_advances = true;
+                break;
+            case INSTR_FOR:
+                n = _clocked_activities (instr->content.loop.body, true,
+                        parent_advances);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                n = _clocked_activities (instr->content.branch.true_body,
+                        looped, parent_advances);
+                if (n >= 0 && instr->content.branch.has_else)
+                {
+                    int m = _clocked_activities (
+                            instr->content.branch.false_body, looped,
+                            parent_advances);
+                    n = m < 0 ? m : n + m;
+                }
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+                n = _clocked_activities (instr->content.block, looped,
+                        parent_advances);
+                break;
+            case INSTR_CLOCKED_ASYNC:
+            {
+                /* Clocked activities spawned by clocked activities are not
+                 * handled.
+                 */
+                bool advances = false;
+                int nested = _clocked_activities (instr->content.block,
+                        looped, & advances);
+                n = nested != 0 ? -1 : looped ? 2 : 1;
+                break;
+            }
+            case INSTR_CLOCKED_FINISH:
+                n = -1;
+                break;
+            default:
+                break;
+        }
+
+        if (n < 0)
+            return n;
+        activities += n;
+    }
+
+    return activities > 2 ? 2 : activities;
+}
+
+instruction_list * _unclock (const instruction_list * list)
+{
+    instruction_list * copy = NULL;
+
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        instruction * new_instr = NULL;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                new_instr = instruction_function_call (
+                        strdup (instr->content.call.identifier),
+                        expression_list_copy (instr->content.call.arguments));
+                break;
+            case INSTR_FOR:
+                new_instr = instruction_for_loop (
+                        strdup (instr->content.loop.identifier),
+                        expression_copy (instr->content.loop.left_boundary),
+                        expression_copy (instr->content.loop.right_boundary),
+                        _unclock (instr->content.loop.body));
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                new_instr = instruction_if_then_else (
+                        instr->content.branch.has_else,
+                        expression_copy (instr->content.branch.condition),
+                        _unclock (instr->content.branch.true_body),
+                        instr->content.branch.has_else
+                            ? _unclock (instr->content.branch.false_body)
+                            : NULL);
+                new_instr->type = instr->type;
+                break;
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+                new_instr = instruction_finish (
+                        _unclock (instr->content.block));
+                break;
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_ASYNC:
+                new_instr = instruction_async (
+                        _unclock (instr->content.block));
+                break;
+            case INSTR_ADVANCE:
+            default:
+                break;
+        }
+
+        if (new_instr != NULL)
+            copy = instruction_list_append (copy, new_instr);
+    }
+
+    return copy;
+}
+
+instruction_list * _lockstep (const instruction_list * program)
+{
+    /* clocked finish { for (i) { clocked async { for (j) { S; advance; } } } }
+     */
+    instruction * finish = _only (program, INSTR_CLOCKED_FINISH);
+    if (finish == NULL)
+        return NULL;
+
+    const instruction * outer = _only (finish->content.block, INSTR_FOR);
+    if (outer == NULL)
+        return NULL;
+
+    const instruction * async = _only (outer->content.loop.body,
+            INSTR_CLOCKED_ASYNC);
+    if (async == NULL)
+        return NULL;
+
+    const instruction * inner = _only (async->content.block, INSTR_FOR);
+    if (inner == NULL)
+        return NULL;
+
+    const instruction_list * body = inner->content.loop.body;
+    if (body == NULL || body->element->type != INSTR_CALL
+        || body->next == NULL || body->next->element->type != INSTR_ADVANCE
+        || body->next->next != NULL)
+        return NULL;
+
+    /* The accesses may let the phases overlap (see
+     * union_map_relax_dates()).
+     */
+    if (body->element->content.call.accesses != NULL)
+        return NULL;
+
+    const char * i = outer->content.loop.identifier;
+    const char * j = inner->content.loop.identifier;
+    const expression * first = inner->content.loop.left_boundary;
+    const expression * last = inner->content.loop.right_boundary;
+    const instruction * call = body->element;
+
+    /* The inner bounds must not depend on the outer iterator, and the date
+     * iterator must be a fresh name.
+     */
+    const char * date = "c0";
+    bool fresh = strcmp (i, date) && strcmp (j, date)
+        && ! expression_uses (first, date) && ! expression_uses (last, date)
+        && ! expression_uses (outer->content.loop.left_boundary, date)
+        && ! expression_uses (outer->content.loop.right_boundary, date);
+    for (const expression_list * a = call->content.call.arguments;
+            a != NULL && fresh; a = a->next)
+        fresh = ! expression_uses (a->element, date);
+
+    if (! fresh || expression_uses (first, i) || expression_uses (last, i))
+        return NULL;
+
+    /* Each activity starts at date 0 and advances once per iteration: the
+     * call of iteration j happens at date j - first.
+     */
+    expression * value = expression_add (expression_copy (first),
+            expression_from_identifier (date));
+    expression_list * arguments = NULL;
+    for (const expression_list * a = call->content.call.arguments; a != NULL;
+            a = a->next)
+        arguments = expression_list_append (arguments,
+                expression_substitute (a->element, j, value));
+    expression_free (value);
+
+    instruction * new_call = instruction_function_call (
+            strdup (call->content.call.identifier), arguments);
+    instruction * activities = instruction_for_loop (strdup (i),
+            expression_copy (outer->content.loop.left_boundary),
+            expression_copy (outer->content.loop.right_boundary),
+            _single (instruction_async (_single (new_call))));
+    instruction * phase = instruction_finish (_single (activities));
+    phase->annotation.date = expression_from_identifier (date);
+    phase->annotation.origin = finish;
+    instruction * dates = instruction_for_loop (strdup (date),
+            expression_from_number (0),
+            expression_sub (expression_copy (last), expression_copy (first)),
+            _single (phase));
+
+    return _single (dates);
+}
+
+instruction_list * _single (instruction * instr)
+{
+    instruction_list * list = instruction_list_alloc ();
+    __forbid_value (list, NULL, "malloc", EX_OSERR);
+    list->element = instr;
+    list->next = NULL;
+    return list;
+}
+
+instruction * _only (const instruction_list * list, instruction_type t)
+{
+    if (list == NULL || list->next != NULL || list->element->type != t)
+        return NULL;
+    return list->element;
+}
@@ -0,0 +1,1015 @@
+/**
+ * \file hoist.c
+ * \brief Loop-invariant hoisting and strength reduction.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "noclock/hoist.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Identifiers bound by the loops between a scope and an expression.
+ * \since version `1.1.0`
+ */
+typedef struct _bound
+{
+    const char * identifier;        /**< The iterator of the loop. */
+    const struct _bound * up;       /**< The enclosing loops. */
+} _bound;
+
+/**
+ * \brief Fresh identifiers.
+ * \since version `1.1.0`
+ */
+typedef struct _names
+{
+    string_list used;               /**< Identifiers already in use. */
+    size_t next;                    /**< Next suffix to try. */
+} _names;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Collect the identifiers of an AST.
+ * \since version `1.1.0`
+ *
+ * \param used The identifiers (modified).
+ * \param list The AST.
+ */
+static void _collect (string_list * used, const instruction_list * list);
+
+/**
+ * \brief Collect the identifiers of an expression.
+ * \since version `1.1.0`
+ *
+ * \param used The identifiers (modified).
+ * \param e The expression.
+ */
+static void _collect_expression (string_list * used, const expression * e);
+
+/**
+ * \brief Get an identifier which is not used yet.
+ * \since version `1.1.0`
+ *
+ * \param names Fresh identifiers.
+ * \return The identifier.
+ */
+static char * _fresh (_names * names);
+
+/**
+ * \brief Collect the identifiers bound by `val`, `var` or assignments.
+ * \since version `1.1.0`
+ *
+ * \param assigned The identifiers (modified).
+ * \param list The AST.
+ */
+static void _assigned (string_list * assigned, const instruction_list * list);
+
+/**
+ * \brief Check whether an expression depends on some identifiers.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \param bound Iterators of the enclosing loops.
+ * \param assigned Identifiers bound by `val`, `var` or assignments.
+ * \return Whether \p e refers to any of them.
+ */
+static bool _depends (const expression * e, const _bound * bound,
+        string_list * assigned);
+
+/**
+ * \brief Count the operations of an expression.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \return The number of unary or binary operations.
+ */
+static size_t _operations (const expression * e);
+
+/**
+ * \brief Check whether evaluating an expression may trap.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \return Whether \p e divides by anything but a nonzero constant.
+ */
+static bool _traps (const expression * e);
+
+/**
+ * \brief Add a copy of an expression to a list, unless it is already there.
+ * \since version `1.1.0`
+ *
+ * \param values The list (modified).
+ * \param e The expression.
+ */
+static void _add (expression_list ** values, const expression * e);
+
+/**
+ * \brief Replace the expressions of a list by identifiers.
+ * \since version `1.1.0`
+ *
+ * \param e The expression (consumed).
+ * \param bound Iterators of the loops enclosing \p e.
+ * \param values The expressions to replace.
+ * \param names The identifiers, in the same order.
+ * \return The new expression.
+ */
+static expression * _replace (expression * e, const _bound * bound,
+        const expression_list * values, string_list * names);
+
+/**
+ * \brief Replace the expressions of a list by identifiers, in an AST.
+ * \since version `1.1.0`
+ *
+ * \param list The AST (modified).
+ * \param bound Iterators of the loops enclosing \p list.
+ * \param asyncs Whether to replace within asyncs too.
+ * \param values The expressions to replace.
+ * \param names The identifiers, in the same order.
+ */
+static void _replace_list (instruction_list * list, const _bound * bound,
+        bool asyncs, const expression_list * values, string_list * names);
+
+/**
+ * \brief Find the largest loop-invariant subexpressions of an expression.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \param bound Iterators of the loops enclosing \p e within the scope.
+ * \param assigned Identifiers bound within the scope.
+ * \param values The invariants (modified).
+ */
+static void _invariants (const expression * e, const _bound * bound,
+        string_list * assigned, expression_list ** values);
+
+/**
+ * \brief Find the loop-invariant subexpressions of an AST.
+ * \since version `1.1.0`
+ *
+ * Only the expressions evaluated within a loop of the scope are considered.
+ *
+ * \param list The AST.
+ * \param bound Iterators of the loops enclosing \p list within the scope.
+ * \param in_loop Whether \p list is within a loop of the scope.
+ * \param assigned Identifiers bound within the scope.
+ * \param values The invariants (modified).
+ */
+static void _find_invariants (const instruction_list * list,
+        const _bound * bound, bool in_loop, string_list * assigned,
+        expression_list ** values);
+
+/**
+ * \brief Hoist the invariants of the loops of a scope to its head.
+ * \since version `1.1.0`
+ *
+ * \param list The scope (modified).
+ * \param names Fresh identifiers.
+ * \return The scope, starting with its bindings.
+ */
+static instruction_list * _hoist_scope (instruction_list * list,
+        _names * names);
+
+/**
+ * \brief Hoist the invariants of the loops of an AST to their bodies.
+ * \since version `1.1.0`
+ *
+ * \param list The AST (modified).
+ * \param names Fresh identifiers.
+ */
+static void _hoist_loops (instruction_list * list, _names * names);
+
+/**
+ * \brief Check whether an expression is affine in an iterator.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \param i The iterator.
+ * \param bound Iterators of the loops enclosing \p e within the loop.
+ * \param assigned Identifiers bound within the loop.
+ * \param coefficient The coefficient of \p i, or `NULL` for 0 (output).
+ * \return Whether \p e is affine in \p i, with loop-invariant terms that
+ * cannot trap.
+ */
+static bool _linear (const expression * e, const char * i,
+        const _bound * bound, string_list * assigned,
+        expression ** coefficient);
+
+/**
+ * \brief Find the largest affine subexpressions of an expression.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \param i The iterator.
+ * \param bound Iterators of the loops enclosing \p e within the loop.
+ * \param assigned Identifiers bound within the loop.
+ * \param values The affine expressions (modified).
+ */
+static void _affines (const expression * e, const char * i,
+        const _bound * bound, string_list * assigned,
+        expression_list ** values);
+
+/**
+ * \brief Find the affine expressions of an iterator in an AST.
+ * \since version `1.1.0`
+ *
+ * The expressions within asyncs are not considered.
+ *
+ * \param list The AST.
+ * \param i The iterator.
+ * \param bound Iterators of the loops enclosing \p list within the loop.
+ * \param assigned Identifiers bound within the loop.
+ * \param values The affine expressions (modified).
+ */
+static void _find_affines (const instruction_list * list, const char * i,
+        const _bound * bound, string_list * assigned,
+        expression_list ** values);
+
+/**
+ * \brief Fold the constants of the additions and multiplications.
+ * \since version `1.1.0`
+ *
+ * \param e The expression (consumed).
+ * \return The folded expression.
+ */
+static expression * _fold (expression * e);
+
+/**
+ * \brief Build the update of a variable.
+ * \since version `1.1.0`
+ *
+ * \param name The variable.
+ * \param coefficient The increment (consumed).
+ * \return `name = (name + coefficient)`.
+ */
+static instruction * _step (const char * name, expression * coefficient);
+
+/**
+ * \brief Reduce the affine expressions of the iterator of a loop.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop (modified).
+ * \param names Fresh identifiers.
+ * \return The declarations of the variables, to insert before the loop.
+ */
+static instruction_list * _reduce_loop (instruction * loop, _names * names);
+
+/**
+ * \brief Reduce the affine expressions of the loops of an AST.
+ * \since version `1.1.0`
+ *
+ * \param list The AST (modified).
+ * \param names Fresh identifiers.
+ * \return The AST.
+ */
+static instruction_list * _reduce_list (instruction_list * list,
+        _names * names);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+instruction_list * instruction_list_hoist (instruction_list * list)
+{
+    _names names = { .next = 0 };
+    string_list_init (& names.used);
+    _collect (& names.used, list);
+
+    list = _hoist_scope (list, & names);
+
+    string_list_clean (& names.used);
+    return list;
+}
+
+instruction_list * instruction_list_reduce_strength (instruction_list * list)
+{
+    _names names = { .next = 0 };
+    string_list_init (& names.used);
+    _collect (& names.used, list);
+
+    list = _reduce_list (list, & names);
+
+    string_list_clean (& names.used);
+    return list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _collect (string_list * used, const instruction_list * list)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                for (const expression_list * a = instr->content.call.arguments;
+                        a != NULL; a = a->next)
+                    _collect_expression (used, a->element);
+                break;
+            case INSTR_FOR:
+                string_list_append (used, instr->content.loop.identifier);
+                _collect_expression (used, instr->content.loop.left_boundary);
+                _collect_expression (used, instr->content.loop.right_boundary);
+                _collect (used, instr->content.loop.body);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _collect_expression (used, instr->content.branch.condition);
+                _collect (used, instr->content.branch.true_body);
+                if (instr->content.branch.has_else)
+                    _collect (used, instr->content.branch.false_body);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _collect (used, instr->content.block);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                string_list_append (used, instr->content.bind.identifier);
+                _collect_expression (used, instr->content.bind.value);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void _collect_expression (string_list * used, const expression * e)
+{
+    if (e == NULL)
+        return;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+            if (string_list_index (used, e->content.identifier) == -1)
+                string_list_append (used, e->content.identifier);
+            break;
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+        case EXPR_UNKNOWN:
+            break;
+        default:
+            _collect_expression (used, e->content.operands.left);
+            _collect_expression (used, e->content.operands.right);
+            break;
+    }
+}
+
+char * _fresh (_names * names)
+{
+    char buffer[32];
+    do
+        snprintf (buffer, sizeof buffer, "v%zu", names->next++);
+    while (string_list_index (& names->used, buffer) != -1);
+
+    string_list_append (& names->used, buffer);
+
+    char * name = strdup (buffer);
+    __forbid_value (name, NULL, "strdup", EX_OSERR);
+    return name;
+}
+
+void _assigned (string_list * assigned, const instruction_list * list)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                _assigned (assigned, instr->content.loop.body);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _assigned (assigned, instr->content.branch.true_body);
+                if (instr->content.branch.has_else)
+                    _assigned (assigned, instr->content.branch.false_body);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _assigned (assigned, instr->content.block);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                string_list_append (assigned, instr->content.bind.identifier);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool _depends (const expression * e, const _bound * bound,
+        string_list * assigned)
+{
+    for (const _bound * b = bound; b != NULL; b = b->up)
+        if (expression_uses (e, b->identifier))
+            return true;
+    for (size_t a = 0; a < assigned->length; ++a)
+        if (expression_uses (e, assigned->list[a]))
+            return true;
+    return false;
+}
+
+size_t _operations (const expression * e)
+{
+    if (e == NULL)
+        return 0;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+        case EXPR_UNKNOWN:
+            return 0;
+        default:
+            return 1 + _operations (e->content.operands.left)
+                + _operations (e->content.operands.right);
+    }
+}
+
+bool _traps (const expression * e)
+{
+    if (e == NULL || _operations (e) == 0)
+        return false;
+
+    const expression * right = e->content.operands.right;
+    if (e->type == EXPR_DIV && ! (expression_is_number (right)
+                && expression_get_number (right) != 0))
+        return true;
+
+    return _traps (e->content.operands.left) || _traps (right);
+}
+
+void _add (expression_list ** values, const expression * e)
+{
+    for (const expression_list * v = * values; v != NULL; v = v->next)
+        if (expression_equal (v->element, e))
+            return;
+    * values = expression_list_append (* values, expression_copy (e));
+}
+
+expression * _replace (expression * e, const _bound * bound,
+        const expression_list * values, string_list * names)
+{
+    if (e == NULL || _operations (e) == 0)
+        return e;
+
+    ssize_t k = 0;
+    for (const expression_list * v = values; v != NULL; v = v->next, ++k)
+        if (expression_equal (v->element, e))
+        {
+            /* An enclosing loop may shadow one of its identifiers. */
+            bool shadowed = false;
+            for (const _bound * b = bound; b != NULL && ! shadowed; b = b->up)
+                shadowed = expression_uses (e, b->identifier);
+            if (shadowed)
+                break;
+
+            expression_free (e);
+            return expression_from_identifier (
+                    string_list_parameter (names, k));
+        }
+
+    e->content.operands.left =
+        _replace (e->content.operands.left, bound, values, names);
+    e->content.operands.right =
+        _replace (e->content.operands.right, bound, values, names);
+    return e;
+}
+
+void _replace_list (instruction_list * list, const _bound * bound,
+        bool asyncs, const expression_list * values, string_list * names)
+{
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                for (expression_list * a = instr->content.call.arguments;
+                        a != NULL; a = a->next)
+                    a->element = _replace (a->element, bound, values, names);
+                break;
+            case INSTR_FOR:
+            {
+                instr->content.loop.left_boundary = _replace (
+                        instr->content.loop.left_boundary, bound, values,
+                        names);
+                instr->content.loop.right_boundary = _replace (
+                        instr->content.loop.right_boundary, bound, values,
+                        names);
+
+                _bound inner = { instr->content.loop.identifier, bound };
+                _replace_list (instr->content.loop.body, & inner, asyncs,
+                        values, names);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                instr->content.branch.condition = _replace (
+                        instr->content.branch.condition, bound, values, names);
+                _replace_list (instr->content.branch.true_body, bound, asyncs,
+                        values, names);
+                if (instr->content.branch.has_else)
+                    _replace_list (instr->content.branch.false_body, bound,
+                            asyncs, values, names);
+                break;
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_ASYNC:
+                if (! asyncs)
+                    break;
+                /* No break here! */
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+                _replace_list (instr->content.block, bound, asyncs, values,
+                        names);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                instr->content.bind.value = _replace (
+                        instr->content.bind.value, bound, values, names);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void _invariants (const expression * e, const _bound * bound,
+        string_list * assigned, expression_list ** values)
+{
+    size_t operations = _operations (e);
+    if (operations == 0)
+        return;
+
+    /* Negating an identifier is not worth a binding. A binding is evaluated
+     * even where its expression was not (behind a guard, or before a loop
+     * that does not run): dividing by anything but a nonzero constant is
+     * left where it is.
+     */
+    bool unary = e->type == EXPR_NEG || e->type == EXPR_NOT;
+    if (operations > (unary ? 1 : 0) && ! _depends (e, bound, assigned)
+        && ! _traps (e))
+    {
+        _add (values, e);
+        return;
+    }
+
+    _invariants (e->content.operands.left, bound, assigned, values);
+    _invariants (e->content.operands.right, bound, assigned, values);
+}
+
+void _find_invariants (const instruction_list * list, const _bound * bound,
+        bool in_loop, string_list * assigned, expression_list ** values)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                for (const expression_list * a = instr->content.call.arguments;
+                        a != NULL && in_loop; a = a->next)
+                    _invariants (a->element, bound, assigned, values);
+                break;
+            case INSTR_FOR:
+            {
+                if (in_loop)
+                {
+                    _invariants (instr->content.loop.left_boundary, bound,
+                            assigned, values);
+                    _invariants (instr->content.loop.right_boundary, bound,
+                            assigned, values);
+                }
+
+                _bound inner = { instr->content.loop.identifier, bound };
+                _find_invariants (instr->content.loop.body, & inner, true,
+                        assigned, values);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                if (in_loop)
+                    _invariants (instr->content.branch.condition, bound,
+                            assigned, values);
+                _find_invariants (instr->content.branch.true_body, bound,
+                        in_loop, assigned, values);
+                if (instr->content.branch.has_else)
+                    _find_invariants (instr->content.branch.false_body, bound,
+                            in_loop, assigned, values);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _find_invariants (instr->content.block, bound, in_loop,
+                        assigned, values);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                if (in_loop)
+                    _invariants (instr->content.bind.value, bound, assigned,
+                            values);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+instruction_list * _hoist_scope (instruction_list * list, _names * names)
+{
+    string_list assigned;
+    string_list_init (& assigned);
+    _assigned (& assigned, list);
+
+    expression_list * values = NULL;
+    _find_invariants (list, NULL, false, & assigned, & values);
+
+    string_list hoisted;
+    string_list_init (& hoisted);
+    instruction_list * bindings = NULL;
+    for (const expression_list * v = values; v != NULL; v = v->next)
+    {
+        char * name = _fresh (names);
+        string_list_append (& hoisted, name);
+        bindings = instruction_list_append (bindings,
+                instruction_binding (INSTR_VAL, name,
+                    expression_copy (v->element)));
+    }
+
+    _replace_list (list, NULL, true, values, & hoisted);
+
+    /* What remains depends on the iterators of the inner loops. */
+    _hoist_loops (list, names);
+
+    expression_list_free (values);
+    string_list_clean (& hoisted);
+    string_list_clean (& assigned);
+
+    return instruction_list_cat (bindings, list);
+}
+
+void _hoist_loops (instruction_list * list, _names * names)
+{
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                instr->content.loop.body =
+                    _hoist_scope (instr->content.loop.body, names);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _hoist_loops (instr->content.branch.true_body, names);
+                if (instr->content.branch.has_else)
+                    _hoist_loops (instr->content.branch.false_body, names);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _hoist_loops (instr->content.block, names);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool _linear (const expression * e, const char * i, const _bound * bound,
+        string_list * assigned, expression ** coefficient)
+{
+    * coefficient = NULL;
+    /* The first value is evaluated before the loop, which may not run. */
+    if (! expression_uses (e, i))
+        return ! _depends (e, bound, assigned) && ! _traps (e);
+
+    const expression * l = e->content.operands.left;
+    const expression * r = e->content.operands.right;
+    expression * left = NULL;
+    expression * right = NULL;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+            * coefficient = expression_from_number (1);
+            return true;
+        case EXPR_NEG:
+            if (! _linear (l, i, bound, assigned, & left))
+                return false;
+            if (expression_is_number (left))
+            {
+                * coefficient =
+                    expression_from_number (- expression_get_number (left));
+                expression_free (left);
+            }
+            else
+                * coefficient = expression_neg (left);
+            return true;
+        case EXPR_ADD:
+        case EXPR_SUB:
+        case EXPR_MULT:
+            if (! _linear (l, i, bound, assigned, & left))
+                return false;
+            if (! _linear (r, i, bound, assigned, & right))
+            {
+                expression_free (left);
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    if (e->type == EXPR_ADD)
+        * coefficient = expression_add (left, right);
+    else if (e->type == EXPR_SUB)
+        * coefficient = left == NULL ? expression_mult (
+                expression_from_number (-1), right)
+            : expression_sub (left, right);
+    else if (left != NULL && right != NULL)
+    {
+        /* Not affine. */
+        expression_free (left);
+        expression_free (right);
+        return false;
+    }
+    else if (left != NULL)
+        * coefficient = expression_mult (left, expression_copy (r));
+    else
+        * coefficient = expression_mult (expression_copy (l), right);
+
+    return true;
+}
+
+void _affines (const expression * e, const char * i, const _bound * bound,
+        string_list * assigned, expression_list ** values)
+{
+    size_t operations = _operations (e);
+    if (operations == 0)
+        return;
+
+    /* A single operation costs as much as the update. */
+    expression * coefficient = NULL;
+    if (operations > 1 && expression_uses (e, i)
+        && _linear (e, i, bound, assigned, & coefficient))
+    {
+        expression_free (coefficient);
+        _add (values, e);
+        return;
+    }
+
+    _affines (e->content.operands.left, i, bound, assigned, values);
+    _affines (e->content.operands.right, i, bound, assigned, values);
+}
+
+void _find_affines (const instruction_list * list, const char * i,
+        const _bound * bound, string_list * assigned,
+        expression_list ** values)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                for (const expression_list * a = instr->content.call.arguments;
+                        a != NULL; a = a->next)
+                    _affines (a->element, i, bound, assigned, values);
+                break;
+            case INSTR_FOR:
+            {
+                _affines (instr->content.loop.left_boundary, i, bound,
+                        assigned, values);
+                _affines (instr->content.loop.right_boundary, i, bound,
+                        assigned, values);
+
+                _bound inner = { instr->content.loop.identifier, bound };
+                _find_affines (instr->content.loop.body, i, & inner, assigned,
+                        values);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _affines (instr->content.branch.condition, i, bound, assigned,
+                        values);
+                _find_affines (instr->content.branch.true_body, i, bound,
+                        assigned, values);
+                if (instr->content.branch.has_else)
+                    _find_affines (instr->content.branch.false_body, i, bound,
+                            assigned, values);
+                break;
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+                _find_affines (instr->content.block, i, bound, assigned,
+                        values);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                _affines (instr->content.bind.value, i, bound, assigned,
+                        values);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+expression * _fold (expression * e)
+{
+    if (_operations (e) == 0)
+        return e;
+
+    expression * left = _fold (e->content.operands.left);
+    expression * right = _fold (e->content.operands.right);
+    e->content.operands.left = NULL;
+    e->content.operands.right = NULL;
+
+    expression * result;
+    switch (e->type)
+    {
+        case EXPR_ADD:
+            result = expression_add (left, right);
+            break;
+        case EXPR_SUB:
+            result = expression_sub (left, right);
+            break;
+        case EXPR_MULT:
+            result = expression_mult (left, right);
+            break;
+        default:
+            e->content.operands.left = left;
+            e->content.operands.right = right;
+            return e;
+    }
+
+    expression_free (e);
+    return result;
+}
+
+instruction * _step (const char * name, expression * coefficient)
+{
+    char * identifier = strdup (name);
+    __forbid_value (identifier, NULL, "strdup", EX_OSERR);
+
+    expression * value;
+    if (expression_is_number (coefficient)
+        && expression_get_number (coefficient) < 0)
+    {
+        value = expression_sub (expression_from_identifier (name),
+                expression_from_number (- expression_get_number (coefficient)));
+        expression_free (coefficient);
+    }
+    else
+        value = expression_add (expression_from_identifier (name),
+                coefficient);
+
+    return instruction_binding (INSTR_ASSIGN, identifier, value);
+}
+
+instruction_list * _reduce_loop (instruction * loop, _names * names)
+{
+    const char * i = loop->content.loop.identifier;
+    instruction_list * body = loop->content.loop.body;
+
+    string_list assigned;
+    string_list_init (& assigned);
+    _assigned (& assigned, body);
+
+    expression_list * values = NULL;
+    _find_affines (body, i, NULL, & assigned, & values);
+
+    string_list reduced;
+    string_list_init (& reduced);
+    instruction_list * declarations = NULL;
+    instruction_list * updates = NULL;
+    for (const expression_list * v = values; v != NULL; v = v->next)
+    {
+        char * name = _fresh (names);
+        string_list_append (& reduced, name);
+
+        expression * coefficient = NULL;
+        _linear (v->element, i, NULL, & assigned, & coefficient);
+
+        updates = instruction_list_append (updates, _step (name, coefficient));
+        declarations = instruction_list_append (declarations,
+                instruction_binding (INSTR_VAR, name,
+                    _fold (expression_substitute (v->element, i,
+                            loop->content.loop.left_boundary))));
+    }
+
+    _replace_list (body, NULL, false, values, & reduced);
+    loop->content.loop.body = instruction_list_cat (body, updates);
+
+    expression_list_free (values);
+    string_list_clean (& reduced);
+    string_list_clean (& assigned);
+
+    return declarations;
+}
+
+instruction_list * _reduce_list (instruction_list * list, _names * names)
+{
+    for (instruction_list ** node = & list; * node != NULL;
+            node = & (* node)->next)
+    {
+        instruction * instr = (* node)->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+            {
+                instr->content.loop.body =
+                    _reduce_list (instr->content.loop.body, names);
+
+                /* The variables are declared right before the loop. */
+                instruction_list * declarations = _reduce_loop (instr, names);
+                if (declarations != NULL)
+                {
+                    instruction_list * last = declarations;
+                    while (last->next != NULL)
+                        last = last->next;
+                    last->next = * node;
+                    * node = declarations;
+                    node = & last->next;
+                }
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                instr->content.branch.true_body =
+                    _reduce_list (instr->content.branch.true_body, names);
+                if (instr->content.branch.has_else)
+                    instr->content.branch.false_body =
+                        _reduce_list (instr->content.branch.false_body, names);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instr->content.block =
+                    _reduce_list (instr->content.block, names);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return list;
+}
@@ -60,6 +60,9 @@ static const char * instruction_type_strings[] =
     [INSTR_ASYNC]           = "async",
     [INSTR_CLOCKED_FINISH]  = "clocked finish",
     [INSTR_CLOCKED_ASYNC]   = "clocked async",
+    [INSTR_VAL]             = "val",
+    [INSTR_VAR]             = "var",
+    [INSTR_ASSIGN]          = "",
     [INSTR_UNKNOWN]         = "",
 };
 
@@ -73,6 +76,7 @@ extern instruction_list * instruction_list_alloc (void);
 extern void instruction_list_free (instruction_list *);
 extern size_t instruction_list_size (instruction_list *);
 extern void instruction_list_fprint (FILE *, const instruction_list *);
+extern instruction_list * instruction_list_copy (const instruction_list *);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Static functions declarations.
@@ -111,6 +115,7 @@ void instruction_free (instruction  * i)
         case INSTR_CALL:
             free (i->content.call.identifier);
             expression_list_free (i->content.call.arguments);
+            access_list_free (i->content.call.accesses);
             break;
         case INSTR_FOR:
             free (i->content.loop.identifier);
@@ -133,6 +138,12 @@ void instruction_free (instruction  * i)
         case INSTR_CLOCKED_ASYNC:
             instruction_list_free (i->content.block);
             break;
+        case INSTR_VAL:
+        case INSTR_VAR:
+        case INSTR_ASSIGN:
+            free (i->content.bind.identifier);
+            expression_free (i->content.bind.value);
+            break;
         default:
             break;
     }
@@ -144,6 +155,80 @@ void instruction_free (instruction  * i)
     free (i);
 }
 
+instruction * instruction_copy (const instruction * i)
+{
+    instruction * copy = instruction_alloc ();
+    copy->type = i->type;
+
+    switch (i->type)
+    {
+        case INSTR_CALL:
+            copy->content.call.identifier = strdup (i->content.call.identifier);
+            __forbid_value (copy->content.call.identifier, NULL, "strdup",
+                    EX_OSERR);
+            copy->content.call.arguments =
+                expression_list_copy (i->content.call.arguments);
+            copy->content.call.accesses =
+                access_list_copy (i->content.call.accesses);
+            break;
+        case INSTR_FOR:
+            copy->content.loop.identifier = strdup (i->content.loop.identifier);
+            __forbid_value (copy->content.loop.identifier, NULL, "strdup",
+                    EX_OSERR);
+            copy->content.loop.left_boundary =
+                expression_copy (i->content.loop.left_boundary);
+            copy->content.loop.right_boundary =
+                expression_copy (i->content.loop.right_boundary);
+            copy->content.loop.body =
+                instruction_list_copy (i->content.loop.body);
+            break;
+        case INSTR_IF:
+        case INSTR_IF_ELSE:
+            copy->content.branch.has_else = i->content.branch.has_else;
+            copy->content.branch.condition =
+                expression_copy (i->content.branch.condition);
+            copy->content.branch.true_body =
+                instruction_list_copy (i->content.branch.true_body);
+            if (i->content.branch.has_else)
+                copy->content.branch.false_body =
+                    instruction_list_copy (i->content.branch.false_body);
+            break;
+        case INSTR_FINISH:
+        case INSTR_ASYNC:
+        case INSTR_CLOCKED_FINISH:
+        case INSTR_CLOCKED_ASYNC:
+            copy->content.block = instruction_list_copy (i->content.block);
+            break;
+        case INSTR_VAL:
+        case INSTR_VAR:
+        case INSTR_ASSIGN:
+            copy->content.bind.identifier = strdup (i->content.bind.identifier);
+            __forbid_value (copy->content.bind.identifier, NULL, "strdup",
+                    EX_OSERR);
+            copy->content.bind.value = expression_copy (i->content.bind.value);
+            break;
+        default:
+            break;
+    }
+
+    if (i->annotation.level != NULL)
+    {
+        copy->annotation.level = strdup (i->annotation.level);
+        __forbid_value (copy->annotation.level, NULL, "strdup", EX_OSERR);
+    }
+    if (i->annotation.boundaries != NULL)
+    {
+        copy->annotation.boundaries = strdup (i->annotation.boundaries);
+        __forbid_value (copy->annotation.boundaries, NULL, "strdup", EX_OSERR);
+    }
+    if (i->annotation.date != NULL)
+        copy->annotation.date = expression_copy (i->annotation.date);
+    copy->annotation.origin = i->annotation.origin;
+    copy->annotation.superstep = i->annotation.superstep;
+
+    return copy;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Constructors.
 ////////////////////////////////////////////////////////////////////////////////
@@ -237,6 +322,18 @@ instruction * instruction_clocked_async (instruction_list * block)
     return i;
 }
 
+instruction * instruction_binding (instruction_type t, char * identifier,
+        expression * value)
+{
+    instruction * i = instruction_alloc ();
+
+    instruction_set_type (i, t);
+    i->content.bind.identifier = identifier;
+    i->content.bind.value = value;
+
+    return i;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Getters.
 ////////////////////////////////////////////////////////////////////////////////
@@ -510,6 +607,12 @@ void instruction_fprint (FILE * f, const instruction * instr)
         case INSTR_IF_ELSE:
             if_then_else_fprint (f, & instr->content.branch);
             break;
+        case INSTR_VAL:
+        case INSTR_VAR:
+        case INSTR_ASSIGN:
+            pretty_print_indent_fprint (f);
+            binding_fprint (f, t, & instr->content.bind);
+            break;
         case INSTR_ADVANCE:
             pretty_print_indent_fprint (f);
 
@@ -696,6 +799,25 @@ void instruction_call_fprint (FILE * f, const function_call * instr)
     else
         fprintf (f, ")");
 
+    access_list_fprint (f, instr->accesses);
+}
+
+void binding_fprint (FILE * f, instruction_type t, const binding * instr)
+{
+    if (instr == NULL)
+        return;
+
+    if (t != INSTR_ASSIGN)
+    {
+        if (pretty_print_colour_state ())
+            fprintf (f, PP_KEYWORD "%s" PP_RESET " ",
+                    instruction_type_to_string (t));
+        else
+            fprintf (f, "%s ", instruction_type_to_string (t));
+    }
+
+    fprintf (f, "%s = ", instr->identifier);
+    expression_fprint (f, instr->value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
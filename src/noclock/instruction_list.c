@@ -47,6 +47,93 @@
  */
 static expression * _count_advances (instruction_list * list);
 
+/**
+ * \brief Wrap the element of a list node in a block construct.
+ * \since version `1.1.0`
+ *
+ * The links of the wrapped instruction and of its wrapper are kept up to
+ * date (see instruction_list_link()).
+ *
+ * \param node List node holding the instruction to wrap.
+ * \param t Wrapper type.
+ */
+static void _wrap_node (instruction_list * node, instruction_type t);
+
+/**
+ * \brief Collect the enclosing instructions of an instruction.
+ * \since version `1.1.0`
+ *
+ * The instructions are stored from the root to \p instr itself, by following
+ * instruction::parent (see instruction_list_link()).
+ *
+ * \param instr Instruction.
+ * \param buffer Buffer to fill, grown when needed.
+ * \param size Size of the buffer.
+ * \return The number of instructions in the path.
+ */
+static size_t _path (instruction * instr, instruction *** buffer,
+        size_t * size);
+
+/**
+ * \brief Detach the first node of an expression list.
+ * \since version `1.1.0`
+ *
+ * \param list Expression list, advanced to its second node.
+ * \return The detached node, or `NULL` if the list is empty.
+ */
+static expression_list * _pop (expression_list ** list);
+
+/**
+ * \brief Find the loop over the dates on the path of a call.
+ * \since version `1.1.0`
+ *
+ * The date of a generated call is its first argument: the loop over the
+ * dates is the outermost loop whose iterator the date depends on.
+ *
+ * \param path The path of the call (see _path()).
+ * \param depth The number of instructions in the path.
+ * \return The index of the loop in \p path, or \p depth if there is none.
+ */
+static size_t _date_loop (instruction ** path, size_t depth);
+
+/**
+ * \brief Count the loops over tiles on the path of a call.
+ * \since version `1.1.0`
+ *
+ * The arguments of a generated call only depend on the loops over points:
+ * the loops over tiles are the leading loops whose iterators they ignore.
+ *
+ * \param path The path of the call (see _path()).
+ * \param depth The number of instructions in the path.
+ * \return The index in \p path right after the last loop over tiles.
+ */
+static size_t _tile_loops (instruction ** path, size_t depth);
+
+/**
+ * \brief Find the argument of a generated call for an enclosing instruction.
+ * \since version `1.1.0`
+ *
+ * \param origin_path The path of the origin of the call (see _path()).
+ * \param a The index of the instruction in \p origin_path.
+ * \return The index of the position of the instruction in the arguments
+ *      (see instruction_list_strip()).
+ */
+static size_t _argument (instruction ** origin_path, size_t a);
+
+/**
+ * \brief Check whether a generated loop only runs through nested levels.
+ * \since version `1.1.0`
+ *
+ * \param loop The generated loop.
+ * \param call The generated call.
+ * \param level The index of an argument of \p call (see _argument()).
+ * \retval true if the iterator of \p loop is only used by the arguments
+ *      after \p level.
+ * \retval false otherwise.
+ */
+static bool _nested_loop (const instruction * loop, const instruction * call,
+        size_t level);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Allocation, initialization, copy, cleaning, free.
 ////////////////////////////////////////////////////////////////////////////////
@@ -84,6 +171,16 @@ void instruction_list_free (instruction_list * list)
     }
 }
 
+instruction_list * instruction_list_copy (const instruction_list * list)
+{
+    instruction_list * copy = NULL;
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+        copy = instruction_list_append (copy,
+                instruction_copy (current->element));
+    return copy;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Operations.
 ////////////////////////////////////////////////////////////////////////////////
@@ -137,128 +234,162 @@ void instruction_list_wrap (instruction_list * list, instruction * instr,
     instruction_list * nth = instruction_list_find_parent (list, instr);
 
     if (nth != NULL && nth->element->type != t)
-    {
-        instruction_list * wrapped = instruction_list_alloc ();
-        wrapped->element = nth->element;
-        wrapped->next = NULL;
-
-        instruction * wrapper = instruction_alloc ();
-        wrapper->type = t;
-        wrapper->content.block = wrapped;
-
-        nth->element = wrapper;
-    }
+        _wrap_node (nth, t);
 }
 
-void instruction_list_fill (instruction_list * list, instruction_list * calls)
+void instruction_list_fill (instruction_list * list, instruction_list * calls,
+        unsigned long int superstep)
 {
+    instruction_list_link (list, NULL);
+
+    size_t path_size = 0;
+    instruction ** path = NULL;
+    size_t origin_path_size = 0;
+    instruction ** origin_path = NULL;
+
     for (instruction_list * current = calls; current != NULL;
             current = current->next)
     {
-        expression_list * expressions =
-            current->element->content.call.arguments;
-
-        bool coord = false;
-        bool stop = false;
-        long int previous_coord = -1;
-        instruction_list * scope = list;
+        instruction * call = current->element;
+        instruction * origin = call->annotation.origin;
+        if (origin == NULL)
+            continue;
+
+        size_t depth = _path (call, & path, & path_size);
+        size_t origin_depth = _path (origin, & origin_path, & origin_path_size);
+
+        /* The scope starts at the loop over the dates. ISL generates none
+         * when the date takes a single value: the rest of the path then
+         * belongs to that phase, as if such a loop enclosed it, below the
+         * loops over tiles (see union_map_tile()).
+         */
+        size_t scope = _date_loop (path, depth);
+        if (scope == depth)
+        {
+            scope = _tile_loops (path, depth);
+            if (depth + 1 > path_size)
+            {
+                path_size = depth + 1;
+                path = realloc (path, path_size * sizeof * path);
+                __forbid_value (path, NULL, "realloc", EX_OSERR);
+            }
+            memmove (path + scope + 1, path + scope,
+                    (depth - scope) * sizeof * path);
+            path[scope] = NULL;
+            ++depth;
+        }
 
-        for (expression_list * current_expr = expressions;
-                current_expr != NULL && ! stop; current_expr = current_expr->next)
+        /* Each finish (resp. async) which enclosed the call in the input
+         * program wraps the child of the current scope which leads to the
+         * call in a finish (resp. an async) and moves the scope into that
+         * wrapper.
+         */
+        size_t first = scope;
+        for (size_t a = 0; a + 1 < origin_depth && scope + 1 < depth
+                && path[scope] != call; ++a)
         {
-            expression * expr = current_expr->element;
-            if (! coord)
+            instruction_type t;
+            switch (origin_path[a]->type)
             {
-                scope = instruction_list_find_parent (scope, current->element);
+                case INSTR_FINISH:
+                case INSTR_CLOCKED_FINISH:
+                    t = INSTR_FINISH;
+                    break;
+                case INSTR_ASYNC:
+                case INSTR_CLOCKED_ASYNC:
+                    t = INSTR_ASYNC;
+                    break;
+                default:
+                    continue;
+            }
 
-                if (previous_coord != -1)
-                {
-                    if (expr->type == EXPR_ID)
-                    {
-                        instruction_list * to_wrap = instruction_body (
-                                scope->element);
-
-                        if (scope->element->type == INSTR_IF
-                            && scope->element->content.branch.has_else)
-                        {
-                            if (instruction_list_is_indirect_parent (
-                                scope->element->content.branch.false_body,
-                                current->element))
-                            {
-                                to_wrap =
-                                    scope->element->content.branch.false_body;
-                            }
-                        }
-
-                        if (to_wrap != NULL)
-                        {
-                            bool wrapped = false;
-                            if (! strcmp (expr->content.identifier, "f"))
-                            {
-                                instruction_list_wrap (to_wrap, current->element,
-                                        INSTR_FINISH);
-                                wrapped = true;
-                            }
-                            else if (! strcmp (expr->content.identifier, "a"))
-                            {
-                                instruction_list_wrap (to_wrap, current->element,
-                                        INSTR_ASYNC);
-                                wrapped = true;
-                            }
-
-                            if (wrapped)
-                            {
-                                to_wrap = instruction_list_find_parent (to_wrap,
-                                        current->element);
-                                scope = to_wrap->element->content.block;
-
-                                if (scope->element == current->element)
-                                    stop = true;
-                            }
-                        }
-                    }
-                }
+            /* Once the phases no longer follow the dates, a generated loop
+             * may run through a loop nested in the wrapper in the input
+             * program: the wrapper then goes around it.
+             */
+            size_t level = _argument (origin_path, a);
+            while (scope > first && path[scope]->type == INSTR_FOR
+                    && _nested_loop (path[scope], call, level))
+                --scope;
+            if (path[scope] != NULL && path[scope]->type == t)
+            {
+                scope += 1;
+                continue;
             }
+
+            instruction * child = path[scope + 1];
+
+            /* An existing wrapper of the same type is entered, otherwise the
+             * child gets wrapped and becomes the new scope.
+             */
+            if (child->type == t)
+                scope += 2;
             else
             {
-                previous_coord = expr->content.number;
+                _wrap_node (child->node, t);
+                scope += 1;
+
+                /* The finish of a clocked finish holds a single phase: it
+                 * remembers its date (the first argument of the call), and
+                 * the clocked finish, since dates of different schedules
+                 * cannot be compared.
+                 */
+                if (origin_path[a]->type == INSTR_CLOCKED_FINISH
+                    && call->content.call.arguments != NULL)
+                {
+                    child->parent->annotation.date = expression_copy (
+                            call->content.call.arguments->element);
+                    child->parent->annotation.origin = origin_path[a];
+                    child->parent->annotation.superstep = superstep;
+                }
             }
-            coord = ! coord;
-
-            size_t list_size = expression_list_size (current_expr);
-            if (list_size <= 3)
-                stop = true;
         }
     }
+
+    free (origin_path);
+    free (path);
 }
 
-void instruction_list_strip (instruction_list * list, string_list * s)
+void instruction_list_strip (instruction_list * list)
 {
+    size_t origin_path_size = 0;
+    instruction ** origin_path = NULL;
+
     for (instruction_list * current = list; current != NULL;
             current = current->next)
     {
-        current->element->content.call.arguments =
-            expression_list_strip
-                (current->element->content.call.arguments);
-
-        size_t n = expression_list_size (
-                current->element->content.call.arguments);
-        n = n > 2 ? n - 2 : 0;
-        expression_list * new_last = expression_list_n (
-                current->element->content.call.arguments, n);
-
-        if (new_last != NULL && new_last->next != NULL
-            && new_last->next->element != NULL
-            && new_last->next->element->type == EXPR_NUMBER)
+        instruction * call = current->element;
+        instruction * origin = call->annotation.origin;
+        if (origin == NULL)
+            continue;
+
+        free (call->content.call.identifier);
+        call->content.call.identifier =
+            strdup (origin->content.call.identifier);
+
+        /* The arguments follow the level of the origin (see
+         * instruction_list_decorate()): the date, then the position of each
+         * enclosing instruction, followed by its iterator if it is a loop,
+         * and finally the position of the call itself. Only the iterators
+         * are kept.
+         */
+        size_t origin_depth = _path (origin, & origin_path, & origin_path_size);
+        expression_list * arguments = call->content.call.arguments;
+        expression_list * kept = NULL;
+
+        expression_list_free (_pop (& arguments));
+        for (size_t a = 0; a + 1 < origin_depth; ++a)
         {
-            free (current->element->content.call.identifier);
-            ssize_t place = new_last->next->element->content.number;
-            current->element->content.call.identifier =
-                strdup (string_list_parameter (s, place));
-            expression_list_free (new_last->next);
-            new_last->next = NULL;
+            expression_list_free (_pop (& arguments));
+            if (origin_path[a]->type == INSTR_FOR)
+                kept = expression_list_cat (kept, _pop (& arguments));
         }
+        expression_list_free (arguments);
+
+        call->content.call.arguments = kept;
     }
+
+    free (origin_path);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -296,8 +427,6 @@ void instruction_list_decorate (instruction_list * list, const char * level,
             switch (t)
             {
                 case INSTR_CALL:
-                    sprintf (next_level, "%s,d", current_level);
-                    sprintf (current_level, "%s", next_level);
                     break;
                 case INSTR_FOR:
                     sprintf (next_level, "%s,%s", current_level,
@@ -340,19 +469,20 @@ void instruction_list_decorate (instruction_list * list, const char * level,
                     break;
                 case INSTR_ADVANCE:
                     break;
+                case INSTR_VAL:
+                case INSTR_VAR:
+                case INSTR_ASSIGN:
+                    break;
                 case INSTR_CLOCKED_FINISH:
                 case INSTR_FINISH:
-                    sprintf (next_level, "%s,f", current_level);
-                    instruction_list_decorate (
-                            current->element->content.block,
-                            next_level, boundaries);
-                    break;
                 case INSTR_ASYNC:
                 case INSTR_CLOCKED_ASYNC:
-                    sprintf (next_level, "%s,a", current_level);
+                    /* Blocks are not dimensions: the calls they enclose are
+                     * tied back to them through instruction_annotation::origin.
+                     */
                     instruction_list_decorate (
                             current->element->content.block,
-                            next_level, boundaries);
+                            current_level, boundaries);
                     break;
                 default:
                     break;
@@ -461,7 +591,9 @@ void instruction_list_compute_dates (instruction_list * list,
         instruction * i = current->element;
         instruction_type t = i->type;
 
-        if (t != INSTR_CALL && t != INSTR_ADVANCE && t != INSTR_UNKNOWN)
+        if (t == INSTR_FOR || t == INSTR_IF || t == INSTR_IF_ELSE
+                || t == INSTR_FINISH || t == INSTR_ASYNC
+                || t == INSTR_CLOCKED_FINISH || t == INSTR_CLOCKED_ASYNC)
         {
             if (t == INSTR_FOR)
             {
@@ -543,7 +675,8 @@ bool instruction_list_is_indirect_parent (instruction_list * list,
                     success = instruction_list_is_indirect_parent (
                             current->element->content.branch.false_body, instr);
             }
-            else if (t != INSTR_CALL && t != INSTR_UNKNOWN && t != INSTR_ADVANCE)
+            else if (t == INSTR_FINISH || t == INSTR_ASYNC
+                    || t == INSTR_CLOCKED_FINISH || t == INSTR_CLOCKED_ASYNC)
                 success = instruction_list_is_indirect_parent (
                         current->element->content.block, instr);
         }
@@ -579,6 +712,43 @@ instruction_list * instruction_list_find_parent (instruction_list * list,
     return parent;
 }
 
+void instruction_list_link (instruction_list * list, instruction * parent)
+{
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * i = current->element;
+        i->parent = parent;
+        i->node = current;
+
+        switch (i->type)
+        {
+            case INSTR_FOR:
+                instruction_list_link (i->content.loop.body, i);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                instruction_list_link (i->content.branch.true_body, i);
+                if (i->content.branch.has_else)
+                    instruction_list_link (i->content.branch.false_body, i);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instruction_list_link (i->content.block, i);
+                break;
+            case INSTR_CALL:
+            case INSTR_ADVANCE:
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+            default:
+                break;
+        }
+    }
+}
+
 instruction_list * call_list (instruction_list * ast)
 {
     instruction_list * list = NULL;
@@ -612,7 +782,8 @@ instruction_list * call_list (instruction_list * ast)
                 list = instruction_list_cat (list, current_instr);
             }
         }
-        else if (t != INSTR_UNKNOWN)
+        else if (t == INSTR_FINISH || t == INSTR_ASYNC
+                || t == INSTR_CLOCKED_FINISH || t == INSTR_CLOCKED_ASYNC)
         {
             instruction_list * current_instr =
                 call_list (current->element->content.block);
@@ -634,7 +805,10 @@ void instruction_list_fprint (FILE * f, const instruction_list * list)
     {
         instruction_fprint (f, current->element);
         if (current->element->type == INSTR_ADVANCE
-                || current->element->type == INSTR_CALL)
+                || current->element->type == INSTR_CALL
+                || current->element->type == INSTR_VAL
+                || current->element->type == INSTR_VAR
+                || current->element->type == INSTR_ASSIGN)
             fprintf (f, ";\n");
     }
 }
@@ -692,3 +866,121 @@ static expression * _count_advances (instruction_list * list)
     return count;
 }
 
+static void _wrap_node (instruction_list * node, instruction_type t)
+{
+    instruction * wrapped_instruction = node->element;
+
+    instruction_list * wrapped = instruction_list_alloc ();
+    wrapped->element = wrapped_instruction;
+    wrapped->next = NULL;
+
+    instruction * wrapper = instruction_alloc ();
+    wrapper->type = t;
+    wrapper->content.block = wrapped;
+    wrapper->parent = wrapped_instruction->parent;
+    wrapper->node = node;
+
+    wrapped_instruction->parent = wrapper;
+    wrapped_instruction->node = wrapped;
+
+    node->element = wrapper;
+}
+
+static size_t _path (instruction * instr, instruction *** buffer,
+        size_t * size)
+{
+    size_t depth = 0;
+    for (instruction * i = instr; i != NULL; i = i->parent)
+        ++depth;
+
+    if (depth > * size)
+    {
+        * size = depth;
+        * buffer = realloc (* buffer, depth * sizeof ** buffer);
+        __forbid_value (* buffer, NULL, "realloc", EX_OSERR);
+    }
+
+    size_t position = depth;
+    for (instruction * i = instr; i != NULL; i = i->parent)
+        (* buffer)[--position] = i;
+
+    return depth;
+}
+
+static expression_list * _pop (expression_list ** list)
+{
+    expression_list * first = * list;
+    if (first != NULL)
+    {
+        * list = first->next;
+        first->next = NULL;
+    }
+    return first;
+}
+
+static size_t _date_loop (instruction ** path, size_t depth)
+{
+    const expression_list * arguments =
+        path[depth - 1]->content.call.arguments;
+    if (arguments == NULL)
+        return depth;
+
+    for (size_t p = 0; p + 1 < depth; ++p)
+        if (path[p]->type == INSTR_FOR
+            && expression_uses (arguments->element,
+                path[p]->content.loop.identifier))
+            return p;
+
+    return depth;
+}
+
+static size_t _tile_loops (instruction ** path, size_t depth)
+{
+    const expression_list * arguments =
+        path[depth - 1]->content.call.arguments;
+
+    size_t end = 0;
+    for (size_t p = 0; p + 1 < depth; ++p)
+    {
+        if (path[p]->type != INSTR_FOR)
+            continue;
+
+        for (const expression_list * a = arguments; a != NULL; a = a->next)
+            if (expression_uses (a->element, path[p]->content.loop.identifier))
+                return end;
+        end = p + 1;
+    }
+
+    return end;
+}
+
+static size_t _argument (instruction ** origin_path, size_t a)
+{
+    /* The date, then a position for each instruction, and an iterator for
+     * each loop.
+     */
+    size_t argument = 1;
+    for (size_t b = 0; b < a; ++b)
+        argument += origin_path[b]->type == INSTR_FOR ? 2 : 1;
+
+    return argument;
+}
+
+static bool _nested_loop (const instruction * loop, const instruction * call,
+        size_t level)
+{
+    const char * iterator = loop->content.loop.identifier;
+    bool nested = false;
+
+    size_t n = 0;
+    for (const expression_list * a = call->content.call.arguments; a != NULL;
+            a = a->next, ++n)
+        if (expression_uses (a->element, iterator))
+        {
+            if (n <= level)
+                return false;
+            nested = true;
+        }
+
+    return nested;
+}
@@ -37,22 +37,147 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 static isl_set_list * instruction_to_set_list (isl_ctx * ctx,
-        const string_list * parameters, const instruction * instr,
-        string_list * s);
+        const string_list * parameters, instruction * instr);
 
 static int _union_set_list (isl_set * el, void * user);
 
-static inline void _shift_map (unsigned int dimension, char * buffer,
-        string_list * s, char * identifier);
+static int _union_set_schedule (isl_set * set, void * user);
 
+/* Stride and offset of the dates, with the map being built. */
+typedef struct _compression
+{
+    isl_val * stride;
+    isl_val * offset;
+    isl_union_map * map;
+} _compression;
+
+static int _union_set_dates (isl_set * set, void * user);
+
+static int _union_set_compress (isl_set * set, void * user);
+
+/* Accesses of the statements. The calls without annotations write to the
+ * clock, the others read it.
+ */
+typedef struct _accesses
+{
+    const string_list * parameters;
+    bool annotated;
+    isl_union_map * reads;
+    isl_union_map * writes;
+    isl_union_map * clock_reads;
+    isl_union_map * clock_writes;
+} _accesses;
+
+/* Pairs of statements, for the instances of a same activity. */
+typedef struct _activities
+{
+    isl_union_set * domain;
+    isl_set * set;
+    isl_union_map * map;
+} _activities;
+
+static _accesses _collect_accesses (isl_union_set * domain,
+        const string_list * parameters);
+
+static int _union_set_accesses (isl_set * set, void * user);
+
+static isl_union_map * _dependences (isl_union_map * schedule,
+        _accesses * a);
+
+static isl_union_map * _clock_order (isl_union_map * schedule,
+        isl_union_set * domain, _accesses * a, isl_union_map ** within);
+
+static isl_union_map * _flow (isl_union_map * schedule, isl_union_map * sink,
+        isl_union_map * must_source, isl_union_map * may_source);
+
+static int _union_set_activities (isl_set * set, void * user);
+
+static int _union_set_same_activity (isl_set * set, void * user);
+
+static const instruction * _activity (const instruction * call,
+        size_t * depth);
+
+static int _union_set_phase_zero (isl_set * set, void * user);
+
+static int _union_map_first (isl_map * map, void * user);
+
+static int _union_map_rest (isl_map * map, void * user);
+
+static int _union_map_instances (isl_map * map, void * user);
+
+static int _union_map_sum (isl_map * map, void * user);
+
+static isl_union_map * _scheduler_phases (isl_union_set * domain,
+        isl_union_map * dependences, bool wavefront);
+
+/* Candidate phases, in order of preference. */
+enum { _SINGLE, _PER_STATEMENT, _SCHEDULER, _DATES, _WAVEFRONT, };
+
+static const char * _origins[] =
+{
+    "single", "per statement", "ISL scheduler", "dates", "wavefront",
+};
+
+/* What the candidate phases must respect. */
+typedef struct _candidates
+{
+    isl_union_map * schedule;
+    isl_union_set * domain;
+    isl_union_map * within;
+    isl_union_map * across;
+} _candidates;
+
+static isl_union_map * _candidate (_candidates * c, size_t origin);
+
+static isl_pw_aff * _critical_path (isl_union_map * phases,
+        isl_union_set * domain);
+
+static bool _shorter (isl_pw_aff * length, isl_pw_aff * best);
+
+static void _report (const char * origin, isl_pw_aff * length);
+
+/* Statements of a domain. */
+typedef struct _statements
+{
+    isl_set ** sets;
+    size_t n;
+} _statements;
+
+static int _union_set_statement (isl_set * set, void * user);
+
+static isl_union_map * _statement_phases (isl_union_set * domain,
+        isl_union_map * within, isl_union_map * across);
+
+static int _distance (isl_union_map * within, isl_union_map * across,
+        isl_set * source, isl_set * sink);
+
+static bool _respects (isl_union_map * phases,
+        isl_union_map * dependences, int distance);
+
+/* Tile sizes and skew, with the tiled schedule being built. */
+typedef struct _tiling
+{
+    const unsigned long int * sizes;
+    size_t count;
+    int skew;
+    isl_size dims;
+    isl_union_map * map;
+} _tiling;
+
+static int _union_map_dims (isl_map * map, void * user);
+
+static int _union_map_tile (isl_map * map, void * user);
+
+static bool _preserves (isl_union_map * schedule, isl_union_map * order);
+
+static int _union_set_superstep (isl_set * set, void * user);
 
 ////////////////////////////////////////////////////////////////////////////////
 // No Clock -> ISL.
 ////////////////////////////////////////////////////////////////////////////////
 
 isl_set_list * program_to_set_list (isl_ctx* ctx,
-        const string_list * parameters, const instruction_list * instructions,
-        string_list * s)
+        const string_list * parameters, const instruction_list * instructions)
 {
     isl_set_list * list = NULL;
 
@@ -60,7 +185,7 @@ isl_set_list * program_to_set_list (isl_ctx* ctx,
             current = current->next)
     {
         isl_set_list * current_list = instruction_to_set_list (
-                ctx, parameters, current->element, s);
+                ctx, parameters, current->element);
 
         if (list == NULL)
             list = current_list;
@@ -78,36 +203,267 @@ isl_union_set * union_set_list (isl_set_list * list)
     return u;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// Static functions definitions.
-////////////////////////////////////////////////////////////////////////////////
+isl_union_map * union_set_schedule (isl_union_set * set)
+{
+    isl_union_map * schedule =
+        isl_union_map_empty (isl_union_set_get_space (set));
+    isl_union_set_foreach_set (set, _union_set_schedule, & schedule);
+    isl_union_set_free (set);
+    return schedule;
+}
+
+isl_union_map * union_map_compress_dates (isl_union_map * schedule)
+{
+    isl_union_set * range = isl_union_map_range (
+            isl_union_map_copy (schedule));
+    isl_set * dates = NULL;
+    isl_union_set_foreach_set (range, _union_set_dates, & dates);
+    if (dates == NULL)
+    {
+        isl_union_set_free (range);
+        return schedule;
+    }
+
+    isl_stride_info * info = isl_set_get_stride_info (dates, 0);
+    isl_val * stride = isl_stride_info_get_stride (info);
+    isl_aff * offset = isl_stride_info_get_offset (info);
+    isl_stride_info_free (info);
+    isl_set_free (dates);
+
+    /* Parametric offsets are left alone. */
+    if (isl_val_is_one (stride) || isl_aff_is_cst (offset) != isl_bool_true)
+    {
+        isl_val_free (stride);
+        isl_aff_free (offset);
+        isl_union_set_free (range);
+        return schedule;
+    }
+
+    _compression c =
+    {
+        .stride = stride,
+        .offset = isl_aff_get_constant_val (offset),
+        .map = isl_union_map_empty (isl_union_map_get_space (schedule)),
+    };
+    isl_aff_free (offset);
+
+    isl_union_set_foreach_set (range, _union_set_compress, & c);
+    isl_union_set_free (range);
+    isl_val_free (c.stride);
+    isl_val_free (c.offset);
+
+    return isl_union_map_apply_range (schedule, c.map);
+}
+
+isl_union_map * union_map_relax_dates (isl_union_map * schedule,
+        const string_list * parameters, bool wavefront)
+{
+    isl_union_set * domain = isl_union_map_domain (
+            isl_union_map_copy (schedule));
+    _accesses a = _collect_accesses (domain, parameters);
+
+    /* Without annotations, the clocks order everything: only wavefronts
+     * are worth looking for.
+     */
+    if (! a.annotated && ! wavefront)
+    {
+        isl_union_map_free (a.reads);
+        isl_union_map_free (a.writes);
+        isl_union_map_free (a.clock_reads);
+        isl_union_map_free (a.clock_writes);
+        isl_union_set_free (domain);
+        return schedule;
+    }
+
+    isl_union_map * within = NULL;
+    isl_union_map * across = _clock_order (schedule, domain, & a, & within);
+
+    if (verbose_mode_state ())
+    {
+        char * across_string = isl_union_map_to_str (across);
+        char * within_string = isl_union_map_to_str (within);
+        fverbosef (stderr, "Across activities:\n\t%s\n", across_string);
+        fverbosef (stderr, "Within activities:\n\t%s\n", within_string);
+        free (across_string);
+        free (within_string);
+    }
+
+    /* A single phase, otherwise one phase per statement, otherwise the
+     * phases of the ISL scheduler, otherwise the dates.
+     */
+    _candidates c =
+    {
+        .schedule = schedule,
+        .domain = domain,
+        .within = within,
+        .across = across,
+    };
+    isl_union_map * phases = NULL;
+    size_t origin;
+    for (origin = 0; a.annotated && origin < _DATES && phases == NULL;
+            ++origin)
+        phases = _candidate (& c, origin);
+    if (phases != NULL)
+        --origin;
+    else
+        origin = _DATES;
+
+    /* The other candidates only replace it with a shorter critical path. */
+    if (wavefront)
+    {
+        if (phases == NULL)
+            phases = _candidate (& c, _DATES);
+        isl_pw_aff * length = _critical_path (phases, domain);
+        _report (_origins[origin], length);
+
+        for (size_t o = 0; o <= _WAVEFRONT; ++o)
+        {
+            isl_union_map * candidate = o == origin || o == _DATES ? NULL
+                : _candidate (& c, o);
+            if (candidate == NULL)
+                continue;
+
+            isl_pw_aff * l = _critical_path (candidate, domain);
+            _report (_origins[o], l);
+            if (_shorter (l, length))
+            {
+                isl_union_map_free (phases);
+                isl_pw_aff_free (length);
+                phases = candidate;
+                length = l;
+                origin = o;
+            }
+            else
+            {
+                isl_union_map_free (candidate);
+                isl_pw_aff_free (l);
+            }
+        }
+        isl_pw_aff_free (length);
+
+        if (origin == _DATES)
+        {
+            isl_union_map_free (phases);
+            phases = NULL;
+        }
+    }
+    fverbosef (stderr, "Phases: %s\n", _origins[origin]);
 
-void _shift_map (unsigned int dimension, char * buffer,
-        string_list * s, char * identifier)
+    isl_union_map_free (within);
+    isl_union_map_free (across);
+    isl_union_set_free (domain);
+
+    if (phases == NULL)
+        return schedule;
+
+    /* S[d, level] -> S[phase, level]: the phase takes the place of the date,
+     * so that the generated calls still start with it.
+     */
+    isl_union_map * rest = isl_union_map_empty (
+            isl_union_map_get_space (schedule));
+    isl_union_map_foreach_map (schedule, _union_map_rest, & rest);
+    isl_union_map * relaxed = isl_union_map_flat_range_product (phases, rest);
+
+    isl_union_set * instances = isl_union_set_empty (
+            isl_union_map_get_space (schedule));
+    isl_union_map_foreach_map (relaxed, _union_map_instances, & instances);
+    isl_union_map_free (relaxed);
+    isl_union_map_free (schedule);
+
+    return union_set_schedule (instances);
+}
+
+isl_union_map * union_map_tile (isl_union_map * schedule,
+        const string_list * parameters, const unsigned long int * sizes,
+        size_t count)
 {
-    int written = 0;
-    unsigned int limit = dimension - 1;
-    char internal_buffer[512] = { '\0' };
+    isl_union_set * domain = isl_union_map_domain (
+            isl_union_map_copy (schedule));
+    _accesses a = _collect_accesses (domain, parameters);
+    isl_union_map * within = NULL;
+    isl_union_map * across = _clock_order (schedule, domain, & a, & within);
+    isl_union_map * order = isl_union_map_union (within, across);
+    isl_union_set_free (domain);
 
-    /* Fill the buffer with the first variables (x0, x1, x2, etc.) */
-    for (unsigned int i = 0; i < limit; ++i)
-        written += sprintf (& internal_buffer[written], "x%u%c", i,
-                i < limit - 1 ? ',' : '\0');
+    _tiling t =
+    {
+        .sizes = sizes,
+        .count = count,
+        .skew = 0,
+        .dims = 0,
+        .map = NULL,
+    };
+    isl_union_map_foreach_map (schedule, _union_map_dims, & t);
 
-    /* Find the index of the current instruction's name.
-     * Append it to the string list if it is not found.
+    /* Rectangular tiles first, then parallelograms leaning more and more
+     * along the dates, until the clock order is preserved.
      */
-    ssize_t place = string_list_index (s, identifier);
-    if (place == -1)
-        place = (ssize_t) string_list_append (s, identifier);
+    isl_union_map * tiled = NULL;
+    for (t.skew = 0; t.skew <= 3; ++t.skew)
+    {
+        t.map = isl_union_map_empty (isl_union_map_get_space (schedule));
+        isl_union_map_foreach_map (schedule, _union_map_tile, & t);
+        tiled = isl_union_map_apply_range (isl_union_map_copy (schedule),
+                t.map);
 
-    /* Pass the very last variable to the first place, and add the index of
-     * the current instruction's name.
+        if (_preserves (tiled, order))
+            break;
+        isl_union_map_free (tiled);
+        tiled = NULL;
+    }
+    isl_union_map_free (order);
+
+    if (tiled == NULL)
+        fverbosef (stderr, "Tiles: none\n");
+    else if (t.skew == 0)
+        fverbosef (stderr, "Tiles: rectangular\n");
+    else
+        fverbosef (stderr, "Tiles: parallelogram (skew %d)\n", t.skew);
+
+    if (tiled == NULL)
+        return schedule;
+
+    isl_union_map_free (schedule);
+    return tiled;
+}
+
+unsigned long int union_map_superstep (isl_union_map * schedule,
+        const string_list * parameters, unsigned long int limit)
+{
+    /* The distances count the iterations of the loop over the dates, which
+     * skips the dates no instance has.
      */
-    sprintf (buffer, "{[%s,x]->[x,%s,%ld]}", internal_buffer, internal_buffer,
-            place);
+    schedule = union_map_compress_dates (isl_union_map_copy (schedule));
+
+    isl_union_set * domain = isl_union_map_domain (
+            isl_union_map_copy (schedule));
+    _accesses a = _collect_accesses (domain, parameters);
+    isl_union_map * within = NULL;
+    isl_union_map * across = _clock_order (schedule, domain, & a, & within);
+    isl_union_map * order = isl_union_map_union (within, across);
+    isl_union_set_free (domain);
+
+    /* { [d' - d] } for each instance at date d' depending on one at d. */
+    isl_union_map * dates = isl_union_map_empty (
+            isl_union_map_get_space (schedule));
+    isl_union_map_foreach_map (schedule, _union_map_first, & dates);
+    order = isl_union_map_apply_range (order, isl_union_map_copy (dates));
+    order = isl_union_map_apply_domain (order, dates);
+    isl_union_set * distances = isl_union_map_deltas (order);
+
+    isl_union_set_foreach_set (distances, _union_set_superstep, & limit);
+    isl_union_set_free (distances);
+    isl_union_map_free (schedule);
+
+    fverbosef (stderr, "Supersteps: %lu phases\n", limit);
+
+    return limit;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
 int _union_set_list (isl_set * el, void * user)
 {
     isl_union_set ** u = (isl_union_set **) user;
@@ -120,9 +476,21 @@ int _union_set_list (isl_set * el, void * user)
     return 0;
 }
 
+int _union_set_schedule (isl_set * set, void * user)
+{
+    isl_union_map ** schedule = (isl_union_map **) user;
+
+    /* Every statement is scheduled at its own coordinates, but in a common
+     * unnamed space so that they are all interleaved.
+     */
+    isl_map * m = isl_map_reset_tuple_id (isl_set_identity (set), isl_dim_out);
+    * schedule = isl_union_map_add_map (* schedule, m);
+
+    return 0;
+}
+
 isl_set_list * instruction_to_set_list (isl_ctx * ctx,
-        const string_list * parameters, const instruction * instr,
-        string_list * s)
+        const string_list * parameters, instruction * instr)
 {
     isl_set_list * list = NULL;
 
@@ -132,27 +500,37 @@ isl_set_list * instruction_to_set_list (isl_ctx * ctx,
         if (t == INSTR_CALL)
         {
             char * parameters_string = string_list_to_string (parameters);
-            char * set_string = malloc (strlen (instr->annotation.level)
-                    + strlen (parameters_string)
-                    + strlen (instr->annotation.boundaries) + 256);
             char * date_string =
                     expression_to_string (instr->annotation.date);
+            /* Calls outside of any loop have no boundaries. */
+            const char * boundaries = instr->annotation.boundaries;
+            char * set_string = malloc (strlen (instr->annotation.level)
+                    + strlen (parameters_string)
+                    + (boundaries != NULL ? strlen (boundaries) : 0)
+                    + strlen (date_string) + 256);
 
-            sprintf (set_string, "[%s] -> { [%s]: %s and d = %s }",
+            sprintf (set_string, "[%s] -> { [d, %s]: %s%sd = %s }",
                     parameters_string, instr->annotation.level,
-                    instr->annotation.boundaries, date_string);
+                    boundaries != NULL ? boundaries : "",
+                    boundaries != NULL ? " and " : "", date_string);
             isl_set * set = isl_set_read_from_str (ctx, set_string);
 
             fverbosef (stderr, "%s:\n", instr->content.call.identifier);
             fverbosef (stderr, "\t%s\n", set_string);
 
-            char shift_map[1024];
-            _shift_map (isl_set_dim (set, isl_dim_set), shift_map, s,
-                    instr->content.call.identifier);
-
-            isl_map * m = isl_map_read_from_str (ctx, shift_map);
-            isl_set * mapped = isl_set_apply (set, m);
-            list = isl_set_list_from_set (mapped);
+            /* ISL already reported why the set could not be read. */
+            if (set == NULL)
+                list = isl_set_list_alloc (ctx, 0);
+            else
+            {
+                /* The statement is named after the call, and remembers it so
+                 * that the generated calls can be tied back to their origin.
+                 */
+                isl_id * id = isl_id_alloc (ctx,
+                        instr->content.call.identifier, instr);
+                set = isl_set_set_tuple_id (set, id);
+                list = isl_set_list_from_set (set);
+            }
 
             free (set_string);
             free (parameters_string);
@@ -164,17 +542,24 @@ isl_set_list * instruction_to_set_list (isl_ctx * ctx,
             {
                 case INSTR_FOR:
                     list = program_to_set_list (ctx, parameters,
-                            instr->content.loop.body, s);
+                            instr->content.loop.body);
                     break;
                 case INSTR_FINISH:
                 case INSTR_CLOCKED_FINISH:
                 case INSTR_ASYNC:
                 case INSTR_CLOCKED_ASYNC:
                     list = program_to_set_list (ctx, parameters,
-                            instr->content.block, s);
+                            instr->content.block);
                     break;
                 case INSTR_IF:
                 case INSTR_IF_ELSE:
+                    /* The sets do not hold the conditions: rather than
+                     * losing the calls of the branches, report the region
+                     * as unreadable.
+                     */
+                    isl_ctx_set_error (ctx, isl_error_unsupported);
+                    list = isl_set_list_alloc (ctx, 0);
+                    break;
                 case INSTR_ADVANCE:
                 default:
                     list = isl_set_list_alloc (ctx, 0);
@@ -184,3 +569,678 @@ isl_set_list * instruction_to_set_list (isl_ctx * ctx,
 
     return list;
 }
+
+int _union_set_dates (isl_set * set, void * user)
+{
+    isl_set ** dates = (isl_set **) user;
+
+    /* Only keep the date, the first dimension. */
+    isl_size n = isl_set_dim (set, isl_dim_set);
+    isl_set * d = isl_set_project_out (set, isl_dim_set, 1, n - 1);
+
+    if (* dates == NULL)
+        * dates = d;
+    else
+        * dates = isl_set_union (* dates, d);
+
+    return 0;
+}
+
+int _union_set_compress (isl_set * set, void * user)
+{
+    _compression * c = (_compression *) user;
+
+    /* [d, ...] -> [floor ((d - offset) / stride), ...] */
+    isl_multi_aff * ma = isl_multi_aff_identity (
+            isl_space_map_from_set (isl_set_get_space (set)));
+    isl_aff * date = isl_multi_aff_get_aff (ma, 0);
+    date = isl_aff_add_constant_val (date,
+            isl_val_neg (isl_val_copy (c->offset)));
+    date = isl_aff_floor (isl_aff_scale_down_val (date,
+                isl_val_copy (c->stride)));
+    ma = isl_multi_aff_set_aff (ma, 0, date);
+
+    c->map = isl_union_map_add_map (c->map, isl_map_from_multi_aff (ma));
+    isl_set_free (set);
+
+    return 0;
+}
+
+_accesses _collect_accesses (isl_union_set * domain,
+        const string_list * parameters)
+{
+    isl_space * space = isl_union_set_get_space (domain);
+    _accesses a =
+    {
+        .parameters = parameters,
+        .annotated = false,
+        .reads = isl_union_map_empty (isl_space_copy (space)),
+        .writes = isl_union_map_empty (isl_space_copy (space)),
+        .clock_reads = isl_union_map_empty (isl_space_copy (space)),
+        .clock_writes = isl_union_map_empty (space),
+    };
+    isl_union_set_foreach_set (domain, _union_set_accesses, & a);
+
+    return a;
+}
+
+int _union_set_accesses (isl_set * set, void * user)
+{
+    _accesses * a = (_accesses *) user;
+    isl_id * id = isl_set_get_tuple_id (set);
+    const instruction * call = isl_id_get_user (id);
+
+    /* The clock is an array of its own, which no input can name. */
+    isl_map * clock = isl_map_from_domain (isl_set_copy (set));
+    clock = isl_map_set_tuple_id (clock, isl_dim_out,
+            isl_id_alloc (isl_set_get_ctx (set), "clock", a));
+
+    isl_space * space = isl_space_params (isl_set_get_space (set));
+    isl_union_map * reads = isl_union_map_empty (isl_space_copy (space));
+    isl_union_map * writes = isl_union_map_empty (space);
+    bool annotated = call->content.call.accesses != NULL;
+
+    char * parameters_string = string_list_to_string (a->parameters);
+    for (const access_list * access = call->content.call.accesses;
+            access != NULL && annotated; access = access->next)
+    {
+        char * access_string = access_list_to_string (access);
+        char * map_string = malloc (strlen (parameters_string)
+                + strlen (call->annotation.level) + strlen (access_string)
+                + 32);
+        __forbid_value (map_string, NULL, "malloc", EX_OSERR);
+        sprintf (map_string, "[%s] -> { [d, %s] -> %s }", parameters_string,
+                call->annotation.level, access_string);
+
+        fverbosef (stderr, "%s:\n\t%s\n", call->content.call.identifier,
+                map_string);
+
+        /* ISL already reported why the access could not be read: the call
+         * keeps its clock order.
+         */
+        isl_map * map = isl_map_read_from_str (isl_set_get_ctx (set),
+                map_string);
+        if (map == NULL)
+            annotated = false;
+        else
+        {
+            map = isl_map_set_tuple_id (map, isl_dim_in, isl_id_copy (id));
+            map = isl_map_intersect_domain (map, isl_set_copy (set));
+            if (access->write)
+                writes = isl_union_map_add_map (writes, map);
+            else
+                reads = isl_union_map_add_map (reads, map);
+        }
+
+        free (map_string);
+        free (access_string);
+    }
+    free (parameters_string);
+
+    if (annotated)
+    {
+        a->annotated = true;
+        a->reads = isl_union_map_union (a->reads, reads);
+        a->writes = isl_union_map_union (a->writes, writes);
+        a->clock_reads = isl_union_map_add_map (a->clock_reads, clock);
+    }
+    else
+    {
+        isl_union_map_free (reads);
+        isl_union_map_free (writes);
+        a->clock_writes = isl_union_map_add_map (a->clock_writes, clock);
+    }
+
+    isl_id_free (id);
+    isl_set_free (set);
+
+    return 0;
+}
+
+isl_union_map * _dependences (isl_union_map * schedule, _accesses * a)
+{
+    /* The accesses to the clock never kill each other. */
+    isl_union_map * flow = _flow (schedule,
+            isl_union_map_union (isl_union_map_copy (a->reads),
+                isl_union_map_copy (a->clock_reads)),
+            isl_union_map_copy (a->writes),
+            isl_union_map_copy (a->clock_writes));
+    isl_union_map * anti = _flow (schedule,
+            isl_union_map_union (isl_union_map_copy (a->writes),
+                isl_union_map_copy (a->clock_writes)),
+            isl_union_map_empty (isl_union_map_get_space (a->writes)),
+            isl_union_map_union (a->reads, a->clock_reads));
+    isl_union_map * output = _flow (schedule,
+            isl_union_map_union (isl_union_map_copy (a->writes),
+                isl_union_map_copy (a->clock_writes)),
+            a->writes, a->clock_writes);
+
+    return isl_union_map_union (isl_union_map_union (flow, anti), output);
+}
+
+isl_union_map * _clock_order (isl_union_map * schedule,
+        isl_union_set * domain, _accesses * a, isl_union_map ** within)
+{
+    isl_union_map * dependences = _dependences (schedule, a);
+
+    /* Instances of a same activity only need to keep their order, while
+     * instances of different activities must be separated by a phase, but
+     * only if they were already separated by the clocks.
+     */
+    _activities activities =
+    {
+        .domain = domain,
+        .set = NULL,
+        .map = isl_union_map_empty (isl_union_set_get_space (domain)),
+    };
+    isl_union_set_foreach_set (domain, _union_set_activities, & activities);
+
+    isl_union_map * dates = isl_union_map_empty (
+            isl_union_set_get_space (domain));
+    isl_union_map_foreach_map (schedule, _union_map_first, & dates);
+    isl_union_map * later = isl_union_map_lex_lt_union_map (
+            isl_union_map_copy (dates), dates);
+
+    isl_union_map * across = isl_union_map_intersect (
+            isl_union_map_subtract (isl_union_map_copy (dependences),
+                isl_union_map_copy (activities.map)), later);
+    * within = isl_union_map_intersect (dependences, activities.map);
+
+    return across;
+}
+
+isl_union_map * _flow (isl_union_map * schedule, isl_union_map * sink,
+        isl_union_map * must_source, isl_union_map * may_source)
+{
+    isl_union_access_info * info = isl_union_access_info_from_sink (sink);
+    info = isl_union_access_info_set_must_source (info, must_source);
+    info = isl_union_access_info_set_may_source (info, may_source);
+    info = isl_union_access_info_set_schedule_map (info,
+            isl_union_map_copy (schedule));
+
+    isl_union_flow * flow = isl_union_access_info_compute_flow (info);
+    isl_union_map * dependences = isl_union_flow_get_may_dependence (flow);
+    isl_union_flow_free (flow);
+
+    return dependences;
+}
+
+int _union_set_activities (isl_set * set, void * user)
+{
+    _activities * activities = (_activities *) user;
+    activities->set = set;
+    isl_union_set_foreach_set (activities->domain, _union_set_same_activity,
+            activities);
+    isl_set_free (set);
+
+    return 0;
+}
+
+int _union_set_same_activity (isl_set * set, void * user)
+{
+    _activities * activities = (_activities *) user;
+    isl_id * source_id = isl_set_get_tuple_id (activities->set);
+    isl_id * sink_id = isl_set_get_tuple_id (set);
+
+    size_t depth = 0;
+    const instruction * source = _activity (isl_id_get_user (source_id),
+            & depth);
+    const instruction * sink = _activity (isl_id_get_user (sink_id), NULL);
+    isl_id_free (source_id);
+    isl_id_free (sink_id);
+
+    /* Both are run by the same activity, for the same iterations of the
+     * loops enclosing its async.
+     */
+    if (source != NULL && source == sink)
+    {
+        isl_map * map = isl_map_from_domain_and_range (
+                isl_set_copy (activities->set), isl_set_copy (set));
+        for (size_t d = 1; d <= depth; ++d)
+            map = isl_map_equate (map, isl_dim_in, d, isl_dim_out, d);
+        activities->map = isl_union_map_add_map (activities->map, map);
+    }
+
+    isl_set_free (set);
+
+    return 0;
+}
+
+const instruction * _activity (const instruction * call, size_t * depth)
+{
+    const instruction * top = call;
+    const instruction * loop = NULL;
+    const instruction * async = call->parent;
+    for (; async != NULL && async->type != INSTR_ASYNC
+            && async->type != INSTR_CLOCKED_ASYNC; async = async->parent)
+    {
+        top = async;
+        if (async->type == INSTR_FOR)
+            loop = async;
+    }
+
+    /* Outside of any async, everything is run by the parent activity. */
+    if (async == NULL)
+        return top;
+
+    /* The calls of an async are spawned apart (see instruction_list_fill()),
+     * unless they share a loop within that async. The level of the async is
+     * a prefix of the level of the call.
+     */
+    if (depth != NULL)
+    {
+        * depth = 1;
+        for (const char * c = async->annotation.level; * c != '\0'; ++c)
+            if (* c == ',')
+                ++ * depth;
+    }
+
+    return loop;
+}
+
+int _union_set_phase_zero (isl_set * set, void * user)
+{
+    isl_union_map ** phases = (isl_union_map **) user;
+
+    isl_map * m = isl_map_add_dims (isl_map_from_domain (set), isl_dim_out, 1);
+    m = isl_map_fix_si (m, isl_dim_out, 0, 0);
+    * phases = isl_union_map_add_map (* phases, m);
+
+    return 0;
+}
+
+int _union_map_first (isl_map * map, void * user)
+{
+    isl_union_map ** first = (isl_union_map **) user;
+
+    /* Statements scheduled in no dimension all happen in phase 0. */
+    isl_size n = isl_map_dim (map, isl_dim_out);
+    if (n == 0)
+    {
+        map = isl_map_add_dims (map, isl_dim_out, 1);
+        map = isl_map_fix_si (map, isl_dim_out, 0, 0);
+    }
+    else
+        map = isl_map_project_out (map, isl_dim_out, 1, n - 1);
+    map = isl_map_reset_tuple_id (map, isl_dim_out);
+    * first = isl_union_map_add_map (* first, map);
+
+    return 0;
+}
+
+int _union_map_rest (isl_map * map, void * user)
+{
+    isl_union_map ** rest = (isl_union_map **) user;
+
+    map = isl_map_project_out (map, isl_dim_out, 0, 1);
+    * rest = isl_union_map_add_map (* rest, map);
+
+    return 0;
+}
+
+int _union_map_sum (isl_map * map, void * user)
+{
+    isl_union_map ** sum = (isl_union_map **) user;
+
+    /* [x1, ..., xn] -> [x1 + ... + xn] */
+    isl_space * space = isl_space_range (isl_map_get_space (map));
+    isl_size n = isl_space_dim (space, isl_dim_set);
+    isl_local_space * ls = isl_local_space_from_space (space);
+    isl_aff * aff = isl_aff_zero_on_domain (isl_local_space_copy (ls));
+    for (isl_size d = 0; d < n; ++d)
+        aff = isl_aff_add (aff, isl_aff_var_on_domain (
+                    isl_local_space_copy (ls), isl_dim_set, d));
+    isl_local_space_free (ls);
+
+    map = isl_map_apply_range (map, isl_map_from_aff (aff));
+    map = isl_map_reset_tuple_id (map, isl_dim_out);
+    * sum = isl_union_map_add_map (* sum, map);
+
+    return 0;
+}
+
+isl_union_map * _scheduler_phases (isl_union_set * domain,
+        isl_union_map * dependences, bool wavefront)
+{
+    isl_schedule_constraints * constraints =
+        isl_schedule_constraints_on_domain (isl_union_set_copy (domain));
+    constraints = isl_schedule_constraints_set_validity (constraints,
+            isl_union_map_copy (dependences));
+    constraints = isl_schedule_constraints_set_proximity (constraints,
+            dependences);
+
+    isl_schedule * schedule =
+        isl_schedule_constraints_compute_schedule (constraints);
+    if (schedule == NULL)
+        return NULL;
+
+    isl_union_map * map = NULL;
+    if (! wavefront)
+        map = isl_schedule_get_map (schedule);
+    else
+    {
+        /* The dimensions of the outermost band can be summed up only if
+         * they are permutable: all the dependences then go forward in each
+         * of them.
+         */
+        isl_schedule_node * node = isl_schedule_node_child (
+                isl_schedule_get_root (schedule), 0);
+        if (isl_schedule_node_get_type (node) == isl_schedule_node_band
+                && isl_schedule_node_band_get_permutable (node)
+                == isl_bool_true)
+            map = isl_schedule_node_band_get_partial_schedule_union_map (
+                    node);
+        isl_schedule_node_free (node);
+    }
+    isl_schedule_free (schedule);
+
+    if (map == NULL)
+        return NULL;
+
+    isl_union_map * phases = isl_union_map_empty (
+            isl_union_map_get_space (map));
+    isl_union_map_foreach_map (map, wavefront ? _union_map_sum
+            : _union_map_first, & phases);
+    isl_union_map_free (map);
+
+    return phases;
+}
+
+bool _respects (isl_union_map * phases, isl_union_map * dependences,
+        int distance)
+{
+    /* Phase of the source -> phase of the sink. */
+    isl_union_map * steps = isl_union_map_apply_range (
+            isl_union_map_apply_domain (isl_union_map_copy (dependences),
+                isl_union_map_copy (phases)),
+            isl_union_map_copy (phases));
+    isl_union_set * deltas = isl_union_map_deltas (steps);
+
+    isl_set * allowed = isl_set_universe (isl_space_set_alloc (
+                isl_union_map_get_ctx (phases), 0, 1));
+    allowed = isl_set_lower_bound_si (allowed, isl_dim_set, 0, distance);
+
+    isl_union_set * bound = isl_union_set_from_set (allowed);
+    isl_bool respects = isl_union_set_is_subset (deltas, bound);
+    isl_union_set_free (deltas);
+    isl_union_set_free (bound);
+
+    return respects == isl_bool_true;
+}
+
+isl_union_map * _candidate (_candidates * c, size_t origin)
+{
+    isl_union_map * phases = NULL;
+    switch (origin)
+    {
+        case _SINGLE:
+            phases = isl_union_map_empty (isl_union_set_get_space (c->domain));
+            isl_union_set_foreach_set (c->domain, _union_set_phase_zero,
+                    & phases);
+            break;
+        case _PER_STATEMENT:
+            phases = _statement_phases (c->domain, c->within, c->across);
+            break;
+        case _SCHEDULER:
+        case _WAVEFRONT:
+            phases = _scheduler_phases (c->domain, isl_union_map_union (
+                        isl_union_map_copy (c->within),
+                        isl_union_map_copy (c->across)),
+                    origin == _WAVEFRONT);
+            break;
+        default:
+            phases = isl_union_map_empty (isl_union_set_get_space (c->domain));
+            isl_union_map_foreach_map (c->schedule, _union_map_first,
+                    & phases);
+            break;
+    }
+
+    if (phases != NULL && (! _respects (phases, c->within, 0)
+                || ! _respects (phases, c->across, 1)))
+    {
+        isl_union_map_free (phases);
+        phases = NULL;
+    }
+
+    return phases;
+}
+
+isl_pw_aff * _critical_path (isl_union_map * phases, isl_union_set * domain)
+{
+    /* All the phases live in the same unnamed space. */
+    isl_set * range = isl_set_from_union_set (isl_union_map_range (
+                isl_union_map_intersect_domain (isl_union_map_copy (phases),
+                    isl_union_set_copy (domain))));
+    isl_pw_aff * first = isl_set_dim_min (isl_set_copy (range), 0);
+    isl_pw_aff * last = isl_set_dim_max (range, 0);
+
+    return isl_pw_aff_add_constant_val (isl_pw_aff_sub (last, first),
+            isl_val_one (isl_union_map_get_ctx (phases)));
+}
+
+bool _shorter (isl_pw_aff * length, isl_pw_aff * best)
+{
+    /* Never longer, and shorter for some parameters. */
+    isl_set * longer = isl_pw_aff_gt_set (isl_pw_aff_copy (length),
+            isl_pw_aff_copy (best));
+    isl_set * shorter = isl_pw_aff_lt_set (isl_pw_aff_copy (length),
+            isl_pw_aff_copy (best));
+    bool result = isl_set_is_empty (longer) == isl_bool_true
+        && isl_set_is_empty (shorter) == isl_bool_false;
+    isl_set_free (longer);
+    isl_set_free (shorter);
+
+    return result;
+}
+
+int _union_map_instances (isl_map * map, void * user)
+{
+    isl_union_set ** instances = (isl_union_set **) user;
+
+    isl_id * id = isl_map_get_tuple_id (map, isl_dim_in);
+    isl_set * set = isl_set_set_tuple_id (isl_map_range (map), id);
+    * instances = isl_union_set_add_set (* instances, set);
+
+    return 0;
+}
+
+int _union_set_statement (isl_set * set, void * user)
+{
+    _statements * statements = (_statements *) user;
+
+    statements->sets = realloc (statements->sets,
+            (statements->n + 1) * sizeof * statements->sets);
+    __forbid_value (statements->sets, NULL, "realloc", EX_OSERR);
+    statements->sets[statements->n++] = set;
+
+    return 0;
+}
+
+isl_union_map * _statement_phases (isl_union_set * domain,
+        isl_union_map * within, isl_union_map * across)
+{
+    _statements statements = { NULL, 0 };
+    isl_union_set_foreach_set (domain, _union_set_statement, & statements);
+
+    int * phase = calloc (statements.n, sizeof * phase);
+    __forbid_value (phase, NULL, "calloc", EX_OSERR);
+
+    /* Longest paths in the graph of the statements, which must not hold a
+     * cycle across activities.
+     */
+    bool changed = true;
+    for (size_t round = 0; changed && round <= statements.n; ++round)
+    {
+        changed = false;
+        for (size_t i = 0; i < statements.n; ++i)
+            for (size_t j = 0; j < statements.n; ++j)
+            {
+                int d = _distance (within, across, statements.sets[i],
+                        statements.sets[j]);
+                if (d >= 0 && phase[j] < phase[i] + d)
+                {
+                    phase[j] = phase[i] + d;
+                    changed = true;
+                }
+            }
+    }
+
+    isl_union_map * phases = changed ? NULL
+        : isl_union_map_empty (isl_union_set_get_space (domain));
+    for (size_t i = 0; i < statements.n; ++i)
+    {
+        if (phases != NULL)
+        {
+            isl_map * m = isl_map_add_dims (isl_map_from_domain (
+                        isl_set_copy (statements.sets[i])), isl_dim_out, 1);
+            m = isl_map_fix_si (m, isl_dim_out, 0, phase[i]);
+            phases = isl_union_map_add_map (phases, m);
+        }
+        isl_set_free (statements.sets[i]);
+    }
+
+    free (statements.sets);
+    free (phase);
+
+    return phases;
+}
+
+int _distance (isl_union_map * within, isl_union_map * across,
+        isl_set * source, isl_set * sink)
+{
+    isl_space * space = isl_space_map_from_domain_and_range (
+            isl_set_get_space (source), isl_set_get_space (sink));
+
+    isl_map * m = isl_union_map_extract_map (across, isl_space_copy (space));
+    bool later = isl_map_is_empty (m) == isl_bool_false;
+    isl_map_free (m);
+
+    m = isl_union_map_extract_map (within, space);
+    bool ordered = isl_map_is_empty (m) == isl_bool_false;
+    isl_map_free (m);
+
+    return later ? 1 : ordered ? 0 : -1;
+}
+
+int _union_map_dims (isl_map * map, void * user)
+{
+    _tiling * t = (_tiling *) user;
+
+    isl_size n = isl_map_dim (map, isl_dim_out);
+    if (n > t->dims)
+        t->dims = n;
+    isl_map_free (map);
+
+    return 0;
+}
+
+int _union_map_tile (isl_map * map, void * user)
+{
+    _tiling * t = (_tiling *) user;
+    isl_id * id = isl_map_get_tuple_id (map, isl_dim_in);
+    const instruction * call = isl_id_get_user (id);
+    isl_id_free (id);
+
+    /* [d, level] -> [floor (d / T0), floor ((i1 + skew * d) / T1), ...,
+     *                d, level, 0, ...]
+     * where i1 is the iterator of the outermost loop of the call, and so on.
+     * A size of 0 or 1 leaves its dimension alone, as does a missing loop.
+     */
+    isl_space * space = isl_space_range (isl_map_get_space (map));
+    isl_size n = isl_space_dim (space, isl_dim_set);
+    isl_local_space * ls = isl_local_space_from_space (
+            isl_space_copy (space));
+    isl_aff_list * list = isl_aff_list_alloc (isl_map_get_ctx (map),
+            t->count + t->dims);
+
+    const char * level = call->annotation.level;
+    int position = 1;
+    for (size_t k = 0; k < t->count; ++k)
+    {
+        /* The iterators are the identifiers of the level. */
+        int dim = k == 0 ? 0 : - 1;
+        for (; k > 0 && level != NULL && * level != '\0' && dim < 0;
+                ++position)
+        {
+            if (isalpha (* level) || * level == '_')
+                dim = position;
+            level = strchr (level, ',');
+            level = level != NULL ? level + 1 : NULL;
+        }
+
+        isl_aff * aff;
+        if (dim < 0 || dim >= n || t->sizes[k] <= 1)
+            aff = isl_aff_zero_on_domain (isl_local_space_copy (ls));
+        else
+        {
+            aff = isl_aff_var_on_domain (isl_local_space_copy (ls),
+                    isl_dim_set, dim);
+            if (dim > 0)
+                aff = isl_aff_add (aff, isl_aff_scale_val (
+                            isl_aff_var_on_domain (isl_local_space_copy (ls),
+                                isl_dim_set, 0),
+                            isl_val_int_from_si (isl_map_get_ctx (map),
+                                t->skew)));
+            aff = isl_aff_floor (isl_aff_scale_down_ui (aff,
+                        (unsigned int) t->sizes[k]));
+        }
+        list = isl_aff_list_add (list, aff);
+    }
+
+    for (isl_size d = 0; d < t->dims; ++d)
+        list = isl_aff_list_add (list, d < n
+                ? isl_aff_var_on_domain (isl_local_space_copy (ls),
+                    isl_dim_set, d)
+                : isl_aff_zero_on_domain (isl_local_space_copy (ls)));
+    isl_local_space_free (ls);
+
+    space = isl_space_add_dims (isl_space_map_from_set (space), isl_dim_out,
+            t->count + t->dims - n);
+    isl_multi_aff * ma = isl_multi_aff_from_aff_list (space, list);
+    t->map = isl_union_map_add_map (t->map, isl_map_from_multi_aff (ma));
+    isl_map_free (map);
+
+    return 0;
+}
+
+bool _preserves (isl_union_map * schedule, isl_union_map * order)
+{
+    isl_union_map * before = isl_union_map_lex_lt_union_map (
+            isl_union_map_copy (schedule), isl_union_map_copy (schedule));
+    isl_bool preserves = isl_union_map_is_subset (order, before);
+    isl_union_map_free (before);
+
+    return preserves == isl_bool_true;
+}
+
+void _report (const char * origin, isl_pw_aff * length)
+{
+    char * length_string = isl_pw_aff_to_str (length);
+    fverbosef (stderr, "Critical path (%s): %s\n", origin,
+            length_string != NULL ? length_string : "unknown");
+    free (length_string);
+}
+
+int _union_set_superstep (isl_set * set, void * user)
+{
+    unsigned long int * limit = (unsigned long int *) user;
+
+    /* The shortest distance between two phases, whatever the parameters. */
+    set = isl_set_lower_bound_si (set, isl_dim_set, 0, 1);
+    set = isl_set_project_out (set, isl_dim_param, 0,
+            isl_set_dim (set, isl_dim_param));
+    if (isl_set_is_empty (set) != isl_bool_true)
+    {
+        set = isl_set_lexmin (set);
+        isl_val * distance = isl_set_plain_get_val_if_fixed (set,
+                isl_dim_set, 0);
+        long int d = isl_val_is_int (distance)
+            ? isl_val_get_num_si (distance) : 1;
+        if (d >= 1 && (unsigned long int) d < * limit)
+            * limit = (unsigned long int) d;
+        isl_val_free (distance);
+    }
+
+    isl_set_free (set);
+    return 0;
+}
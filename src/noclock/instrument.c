@@ -0,0 +1,359 @@
+/**
+ * \file instrument.c
+ * \brief Timing probes.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/instrument.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief State of the instrumentation.
+ * \since version `1.1.0`
+ */
+typedef struct _context
+{
+    FILE * map;                 /**< Output file of the probe map. */
+    size_t next;                /**< Id of the next probe. */
+    string_list loops;          /**< Iterators of the enclosing loops. */
+} _context;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/** Names of the kinds of probes in the probe map. */
+static const char * _probe_kind_strings[] =
+{
+    [PROBE_FINISH] = "finish",
+    [PROBE_ASYNC] = "async",
+    [PROBE_PHASE] = "phase",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Whether the body of a loop waits for a finish or reaches an advance.
+ * \since version `1.1.0`
+ *
+ * Nested loops and asyncs are not looked into.
+ *
+ * \param list Body of the loop.
+ * \retval true if so.
+ */
+static bool _has_phases (const instruction_list * list);
+
+/**
+ * \brief Gather the identifiers of the calls of instructions.
+ * \since version `1.1.0`
+ *
+ * \param list Instructions.
+ * \param calls Identifiers, each only once.
+ */
+static void _calls (const instruction_list * list, string_list * calls);
+
+/**
+ * \brief Count the calls of instructions, when they always run the same.
+ * \since version `1.1.0`
+ *
+ * \param list Instructions.
+ * \param count Number of calls.
+ * \retval true if there are neither loops, conditions nor activities.
+ */
+static bool _call_count (const instruction_list * list, size_t * count);
+
+/**
+ * \brief Give an id to a probe and describe it in the probe map.
+ * \since version `1.1.0`
+ *
+ * \param c Context.
+ * \param kind Kind of the probe.
+ * \param list Instructions it times.
+ * \return The id.
+ */
+static size_t _describe (_context * c, probe_kind kind,
+        const instruction_list * list);
+
+/**
+ * \brief Create a probe.
+ * \since version `1.1.0`
+ *
+ * \param c Context.
+ * \param function Either `noclock_probe_enter` or `noclock_probe_exit`.
+ * \param id Id of the probe.
+ * \return The call.
+ */
+static instruction * _probe (const _context * c, const char * function,
+        size_t id);
+
+/**
+ * \brief Time instructions.
+ * \since version `1.1.0`
+ *
+ * \param c Context.
+ * \param list Instructions.
+ * \param id Id of the probe.
+ * \return The instructions between the probes.
+ */
+static instruction_list * _wrap (const _context * c, instruction_list * list,
+        size_t id);
+
+/**
+ * \brief Add the probes of instructions.
+ * \since version `1.1.0`
+ *
+ * \param c Context.
+ * \param list Instructions (modified).
+ */
+static void _instrument (_context * c, instruction_list ** list);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+instruction_list * instruction_list_instrument (instruction_list * list,
+        FILE * map)
+{
+    _context c = { .map = map, .next = 0, };
+    string_list_init (& c.loops);
+
+    _instrument (& c, & list);
+
+    string_list_clean (& c.loops);
+    return list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+bool _has_phases (const instruction_list * list)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_ADVANCE:
+                return true;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                if (_has_phases (instr->content.branch.true_body)
+                    || (instr->content.branch.has_else
+                        && _has_phases (instr->content.branch.false_body)))
+                    return true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+void _calls (const instruction_list * list, string_list * calls)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                if (string_list_index (calls,
+                            instr->content.call.identifier) < 0)
+                    string_list_append (calls,
+                            instr->content.call.identifier);
+                break;
+            case INSTR_FOR:
+                _calls (instr->content.loop.body, calls);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _calls (instr->content.branch.true_body, calls);
+                if (instr->content.branch.has_else)
+                    _calls (instr->content.branch.false_body, calls);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _calls (instr->content.block, calls);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool _call_count (const instruction_list * list, size_t * count)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        switch (current->element->type)
+        {
+            case INSTR_CALL:
+                ++ * count;
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+size_t _describe (_context * c, probe_kind kind, const instruction_list * list)
+{
+    size_t id = c->next++;
+    if (c->map == NULL)
+        return id;
+
+    string_list calls;
+    string_list_init (& calls);
+    _calls (list, & calls);
+
+    fprintf (c->map, "%zu %s %s ", id, _probe_kind_strings[kind],
+            c->loops.length > 0 ? c->loops.list[c->loops.length - 1] : "-");
+    for (size_t i = 0; i < calls.length; ++i)
+        fprintf (c->map, "%s%s", i > 0 ? "," : "", calls.list[i]);
+    fprintf (c->map, "%s", calls.length > 0 ? "" : "-");
+
+    size_t count = 0;
+    if (_call_count (list, & count))
+        fprintf (c->map, " %zu\n", count);
+    else
+        fprintf (c->map, " -\n");
+
+    string_list_clean (& calls);
+    return id;
+}
+
+instruction * _probe (const _context * c, const char * function, size_t id)
+{
+    char * identifier = strdup (function);
+    __forbid_value (identifier, NULL, "strdup", EX_OSERR);
+
+    expression_list * arguments = expression_list_append (NULL,
+            expression_from_number ((long int) id));
+    arguments = expression_list_append (arguments, c->loops.length > 0
+            ? expression_from_identifier (c->loops.list[c->loops.length - 1])
+            : expression_from_number (0));
+
+    return instruction_function_call (identifier, arguments);
+}
+
+instruction_list * _wrap (const _context * c, instruction_list * list,
+        size_t id)
+{
+    instruction_list * enter = instruction_list_append (NULL,
+            _probe (c, "noclock_probe_enter", id));
+    enter->next = list;
+    instruction_list_append (enter, _probe (c, "noclock_probe_exit", id));
+
+    return enter;
+}
+
+void _instrument (_context * c, instruction_list ** list)
+{
+    for (instruction_list ** node = list; * node != NULL;
+            node = & (* node)->next)
+    {
+        instruction * instr = (* node)->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+            {
+                /* The iterations of a loop of phases are its phases. */
+                size_t loops = c->loops.length;
+                string_list_append (& c->loops, instr->content.loop.identifier);
+
+                bool phases = _has_phases (instr->content.loop.body);
+                size_t id = phases
+                    ? _describe (c, PROBE_PHASE, instr->content.loop.body) : 0;
+                _instrument (c, & instr->content.loop.body);
+                if (phases)
+                    instr->content.loop.body = _wrap (c,
+                            instr->content.loop.body, id);
+
+                free (c->loops.list[loops]);
+                c->loops.length = loops;
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _instrument (c, & instr->content.branch.true_body);
+                if (instr->content.branch.has_else)
+                    _instrument (c, & instr->content.branch.false_body);
+                break;
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_ASYNC:
+            {
+                size_t id = _describe (c, PROBE_ASYNC, instr->content.block);
+                _instrument (c, & instr->content.block);
+                instr->content.block = _wrap (c, instr->content.block, id);
+                break;
+            }
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+            {
+                /* The finish is timed until its activities are done. */
+                size_t id = _describe (c, PROBE_FINISH, instr->content.block);
+                _instrument (c, & instr->content.block);
+
+                instruction_list * finish = * node;
+                instruction_list * rest = finish->next;
+                finish->next = NULL;
+                * node = _wrap (c, finish, id);
+
+                /* Skip the finish and its exit probe. */
+                node = & (* node)->next->next;
+                (* node)->next = rest;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
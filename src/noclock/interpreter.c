@@ -0,0 +1,1158 @@
+/**
+ * \file interpreter.c
+ * \brief Parallel interpreter.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/interpreter.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Value of a local.
+ * \since version `1.1.0`
+ */
+typedef struct _run_binding
+{
+    const char * identifier;        /**< The local. */
+    long int value;                 /**< Its value. */
+} _run_binding;
+
+/**
+ * \brief Function of an *S* instruction.
+ * \since version `1.1.0`
+ */
+typedef struct _run_kernel
+{
+    const char * identifier;        /**< The instruction. */
+    interpreter_kernel function;    /**< The function, `NULL` if none. */
+} _run_kernel;
+
+/**
+ * \brief Storage of a deque.
+ * \since version `1.1.0`
+ *
+ * Thieves may still read a ring replaced by a bigger one: it is only released
+ * with the deque.
+ */
+typedef struct _run_ring
+{
+    long int mask;                  /**< Number of slots, minus one. */
+    struct _run_ring * retired;     /**< The ring it replaced. */
+    void * slots[];                 /**< The tasks. */
+} _run_ring;
+
+/**
+ * \brief Work-stealing deque.
+ * \since version `1.1.0`
+ *
+ * After "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et
+ * al., 2013): only the owner pushes and pops, at the bottom; thieves take
+ * from the top.
+ */
+typedef struct _run_deque
+{
+    long int top;                   /**< Next task to steal. */
+    char padding[64];               /**< Keeps both ends apart. */
+    long int bottom;                /**< Next free slot. */
+    _run_ring * array;              /**< The slots. */
+} _run_deque;
+
+/**
+ * \brief Worker of the pool.
+ * \since version `1.1.0`
+ */
+typedef struct _run_worker
+{
+    _run_deque tasks;               /**< Asyncs waiting to run. */
+    struct _run_state * state;      /**< The run. */
+    pthread_t thread;               /**< Its thread. */
+} _run_worker;
+
+/**
+ * \brief Finish block.
+ * \since version `1.1.0`
+ */
+typedef struct _run_finish
+{
+    unsigned long int pending;      /**< Activities still running. */
+} _run_finish;
+
+/**
+ * \brief Clock of a clocked finish.
+ * \since version `1.1.0`
+ *
+ * The state packs the number of registered activities (high half) with the
+ * number of those which reached the end of the current phase (low half), as
+ * in the SPMD back end.
+ */
+typedef struct _run_clock
+{
+    uint64_t state;                 /**< Registered and arrived activities. */
+    unsigned long int phase;        /**< Current phase. */
+    bool main;                      /**< Whether its phases are measured. */
+} _run_clock;
+
+/**
+ * \brief Async waiting to run.
+ * \since version `1.1.0`
+ */
+typedef struct _run_task
+{
+    struct _run_state * state;      /**< The run. */
+    const instruction_list * body;  /**< The body of the async. */
+    _run_finish * finish;           /**< The finish it belongs to. */
+    _run_clock * clock;             /**< Its clock, if clocked. */
+    struct _run_task * next;        /**< Next task spawned outside the pool. */
+    size_t length;                  /**< Number of locals. */
+    _run_binding bindings[];        /**< The locals, by value. */
+} _run_task;
+
+/**
+ * \brief State of a run.
+ * \since version `1.1.0`
+ */
+typedef struct _run_state
+{
+    _run_kernel * kernels;          /**< The functions of the program. */
+    size_t kernel_count;            /**< Number of functions. */
+    _run_worker * workers;          /**< The pool. */
+    size_t worker_count;            /**< Number of workers. */
+    bool stop;                      /**< Whether the workers should stop. */
+    pthread_mutex_t lock;           /**< Protects the shared tasks and phases. */
+    _run_task * shared;             /**< Tasks spawned outside the pool. */
+    unsigned long int activities;   /**< Number of ended asyncs. */
+    unsigned long int calls;        /**< Number of ended calls. */
+    double last;                    /**< End of the previous phase. */
+    unsigned long int ended;        /**< Ended asyncs at that time. */
+    interpreter_stats * stats;      /**< The measures. */
+} _run_state;
+
+/**
+ * \brief Running activity.
+ * \since version `1.1.0`
+ */
+typedef struct _run_activity
+{
+    _run_state * state;             /**< The run. */
+    _run_finish * finish;           /**< The innermost finish. */
+    _run_clock * clock;             /**< The clock it advances, if any. */
+    bool main;                      /**< Whether it runs the program itself. */
+    size_t length;                  /**< Number of locals. */
+    size_t size;                    /**< Room for the locals. */
+    _run_binding * bindings;        /**< The locals. */
+    _run_binding room[16];          /**< Room for the first locals. */
+    unsigned long int calls;        /**< Number of calls so far. */
+} _run_activity;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief The worker of the current thread, `NULL` outside of the pool.
+ * \since version `1.1.0`
+ */
+static __thread _run_worker * _run_current = NULL;
+
+/**
+ * \brief State of the choice of victims of the current thread.
+ * \since version `1.1.0`
+ */
+static __thread unsigned long int _run_seed = 0;
+
+/**
+ * \brief Beyond this many asyncs in a deque, spawns run right away.
+ * \since version `1.1.0`
+ */
+static const long int _run_cutoff = 256;
+
+/**
+ * \brief One registered activity, in the state of a clock.
+ * \since version `1.1.0`
+ */
+static const uint64_t _run_one = (uint64_t) 1 << 32;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Current time.
+ * \return Seconds since an arbitrary point.
+ */
+static double _run_now (void);
+
+/**
+ * \brief Initialize a deque.
+ * \param d Deque.
+ */
+static void _run_deque_init (_run_deque * d);
+
+/**
+ * \brief Clean a deque.
+ * \param d Deque.
+ */
+static void _run_deque_clean (_run_deque * d);
+
+/**
+ * \brief Push a task at the bottom of a deque (owner only).
+ * \param d Deque.
+ * \param task Task.
+ */
+static void _run_deque_push (_run_deque * d, _run_task * task);
+
+/**
+ * \brief Pop a task from the bottom of a deque (owner only).
+ * \param d Deque.
+ * \return The task, or `NULL`.
+ */
+static _run_task * _run_deque_pop (_run_deque * d);
+
+/**
+ * \brief Steal a task from the top of a deque.
+ * \param d Deque.
+ * \return The task, or `NULL`.
+ */
+static _run_task * _run_deque_steal (_run_deque * d);
+
+/**
+ * \brief Find a task: from the worker's own deque, from another worker, or
+ * among the tasks spawned outside the pool.
+ * \param s Run.
+ * \return The task, or `NULL`.
+ */
+static _run_task * _run_find (_run_state * s);
+
+/**
+ * \brief Run a task if there is one, or else back off.
+ * \param s Run.
+ * \param idle Number of consecutive failures.
+ */
+static void _run_help (_run_state * s, unsigned int * idle);
+
+/**
+ * \brief Main loop of the workers.
+ * \param data The worker.
+ * \return `NULL`.
+ */
+static void * _run_worker_main (void * data);
+
+/**
+ * \brief Main function of the threads of clocked asyncs.
+ * \param data The task.
+ * \return `NULL`.
+ */
+static void * _run_thread_main (void * data);
+
+/**
+ * \brief Wait for the asyncs of a finish, running other asyncs meanwhile.
+ * \param s Run.
+ * \param f Finish.
+ */
+static void _run_wait (_run_state * s, _run_finish * f);
+
+/**
+ * \brief Record the end of a phase.
+ * \param s Run.
+ * \param clocked Whether a clock ends the phase.
+ * \param registered Activities registered on the clock.
+ */
+static void _run_phase (_run_state * s, bool clocked,
+        unsigned long int registered);
+
+/**
+ * \brief Start the next phase of a clock, once every activity arrived.
+ * \param s Run.
+ * \param c Clock.
+ * \param state State of the clock.
+ */
+static void _run_clock_next (_run_state * s, _run_clock * c, uint64_t state);
+
+/**
+ * \brief Wait for the end of the current phase of a clock.
+ * \param s Run.
+ * \param c Clock.
+ */
+static void _run_clock_advance (_run_state * s, _run_clock * c);
+
+/**
+ * \brief Unregister an activity from a clock.
+ * \param s Run.
+ * \param c Clock.
+ */
+static void _run_clock_drop (_run_state * s, _run_clock * c);
+
+/**
+ * \brief Find or add the function of an *S* instruction.
+ * \param s Run.
+ * \param identifier The instruction.
+ * \param library Shared object, or `NULL`.
+ * \retval true if found.
+ * \retval false if missing from the shared object.
+ */
+static bool _run_kernel_resolve (_run_state * s, const char * identifier,
+        void * library);
+
+/**
+ * \brief Resolve the functions of the *S* instructions of a program.
+ * \param s Run.
+ * \param list Program.
+ * \param library Shared object, or `NULL`.
+ * \retval true if found.
+ * \retval false if one of them is missing from the shared object.
+ */
+static bool _run_kernels_resolve (_run_state * s, const instruction_list * list,
+        void * library);
+
+/**
+ * \brief Bind a local.
+ * \param a Activity.
+ * \param identifier Local.
+ * \param value Value.
+ */
+static void _run_bind (_run_activity * a, const char * identifier,
+        long int value);
+
+/**
+ * \brief Find the innermost binding of a local.
+ * \param a Activity.
+ * \param identifier Local.
+ * \return Its index among the bindings of the activity.
+ */
+static size_t _run_lookup (const _run_activity * a, const char * identifier);
+
+/**
+ * \brief Evaluate an expression.
+ * \param e Expression.
+ * \param a Activity.
+ * \return The value, `1` or `0` for boolean expressions.
+ */
+static long int _run_expression (const expression * e, const _run_activity * a);
+
+/**
+ * \brief Run a block: its locals are unbound at its end.
+ * \param list Instructions.
+ * \param a Activity.
+ */
+static void _run_block (const instruction_list * list, _run_activity * a);
+
+/**
+ * \brief Run a finish block.
+ * \param instr Finish or clocked finish.
+ * \param a Activity.
+ */
+static void _run_finish_block (const instruction * instr, _run_activity * a);
+
+/**
+ * \brief Spawn an async.
+ * \param instr Async or clocked async.
+ * \param a Activity.
+ */
+static void _run_spawn (const instruction * instr, _run_activity * a);
+
+/**
+ * \brief Run an async.
+ * \param task The async, freed.
+ */
+static void _run_task_execute (_run_task * task);
+
+/**
+ * \brief Run an instruction.
+ * \param instr Instruction.
+ * \param a Activity.
+ */
+static void _run_instruction (const instruction * instr, _run_activity * a);
+
+////////////////////////////////////////////////////////////////////////////////
+// Allocation, initialization, copy, cleaning, free.
+////////////////////////////////////////////////////////////////////////////////
+
+void interpreter_stats_init (interpreter_stats * stats)
+{
+    stats->workers = 0;
+    stats->seconds = 0;
+    stats->activities = 0;
+    stats->calls = 0;
+    stats->phase_count = 0;
+    stats->phase_size = 0;
+    stats->phases = NULL;
+}
+
+void interpreter_stats_clean (interpreter_stats * stats)
+{
+    free (stats->phases);
+    interpreter_stats_init (stats);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Running.
+////////////////////////////////////////////////////////////////////////////////
+
+int instruction_list_run (const instruction_list * list,
+        const string_list * parameters, const long int * values,
+        const char * library, size_t workers, interpreter_stats * stats)
+{
+    /* Resolve the functions first, so that a missing one is reported before
+     * anything runs.
+     */
+    void * handle = NULL;
+    if (library != NULL)
+    {
+        handle = dlopen (library, RTLD_NOW);
+        if (handle == NULL)
+        {
+            fprintf (stderr, "Error: %s\n", dlerror ());
+            return EX_NOINPUT;
+        }
+    }
+
+    _run_state s;
+    s.kernels = NULL;
+    s.kernel_count = 0;
+    if (! _run_kernels_resolve (& s, list, handle))
+    {
+        free (s.kernels);
+        if (handle != NULL)
+            dlclose (handle);
+        return EX_DATAERR;
+    }
+
+    if (workers == 0)
+    {
+        long int processors = sysconf (_SC_NPROCESSORS_ONLN);
+        workers = processors > 0 ? (size_t) processors : 1;
+    }
+
+    s.worker_count = workers;
+    s.workers = malloc (workers * sizeof * s.workers);
+    __forbid_value (s.workers, NULL, "malloc", EX_OSERR);
+    s.stop = false;
+    pthread_mutex_init (& s.lock, NULL);
+    s.shared = NULL;
+    s.activities = 0;
+    s.calls = 0;
+    s.ended = 0;
+    s.stats = stats;
+    stats->workers = workers;
+
+    for (size_t w = 0; w < workers; ++w)
+    {
+        _run_deque_init (& s.workers[w].tasks);
+        s.workers[w].state = & s;
+    }
+
+    /* The program runs within an implicit finish. */
+    _run_finish top = { 0 };
+    _run_activity program;
+    program.state = & s;
+    program.finish = & top;
+    program.clock = NULL;
+    program.main = true;
+    program.length = 0;
+    program.size = sizeof program.room / sizeof * program.room;
+    program.bindings = program.room;
+    program.calls = 0;
+    for (size_t i = 0; i < parameters->length; ++i)
+        _run_bind (& program, parameters->list[i], values[i]);
+
+    s.last = _run_now ();
+    double start = s.last;
+
+    for (size_t w = 1; w < workers; ++w)
+        if (pthread_create (& s.workers[w].thread, NULL, _run_worker_main,
+                    & s.workers[w]))
+        {
+            perror ("pthread_create");
+            exit (EX_OSERR);
+        }
+
+    /* The calling thread is the first worker. */
+    _run_current = & s.workers[0];
+    _run_seed = 2654435761ul;
+
+    _run_block (list, & program);
+    _run_wait (& s, & top);
+    __atomic_add_fetch (& s.calls, program.calls, __ATOMIC_RELAXED);
+
+    if (stats->phase_count == 0
+            || __atomic_load_n (& s.activities, __ATOMIC_ACQUIRE) != s.ended)
+        _run_phase (& s, false, 0);
+    stats->seconds = _run_now () - start;
+
+    __atomic_store_n (& s.stop, true, __ATOMIC_RELEASE);
+    for (size_t w = 1; w < workers; ++w)
+        pthread_join (s.workers[w].thread, NULL);
+    _run_current = NULL;
+
+    stats->activities = s.activities;
+    stats->calls = s.calls;
+
+    /* Clean up. */
+    for (size_t w = 0; w < workers; ++w)
+        _run_deque_clean (& s.workers[w].tasks);
+    free (s.workers);
+    pthread_mutex_destroy (& s.lock);
+    if (program.bindings != program.room)
+        free (program.bindings);
+    free (s.kernels);
+    if (handle != NULL)
+        dlclose (handle);
+
+    return EXIT_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+void interpreter_stats_fprint (FILE * f, const interpreter_stats * stats)
+{
+    fprintf (f, "%-16s%zu\n", "workers", stats->workers);
+    fprintf (f, "%-16s%.9f s\n", "wall time", stats->seconds);
+    fprintf (f, "%-16s%lu\n", "activities", stats->activities);
+    fprintf (f, "%-16s%lu\n", "calls", stats->calls);
+    fprintf (f, "%-16s%zu\n", "phases", stats->phase_count);
+    for (size_t p = 0; p < stats->phase_count; ++p)
+        fprintf (f, "phase %-10zu%.9f s, %lu activities\n", p,
+                stats->phases[p].seconds, stats->phases[p].activities);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+double _run_now (void)
+{
+    struct timespec t;
+    clock_gettime (CLOCK_MONOTONIC, & t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+void _run_deque_init (_run_deque * d)
+{
+    d->top = 0;
+    d->bottom = 0;
+    d->array = malloc (sizeof * d->array + 64 * sizeof * d->array->slots);
+    __forbid_value (d->array, NULL, "malloc", EX_OSERR);
+    d->array->mask = 63;
+    d->array->retired = NULL;
+}
+
+void _run_deque_clean (_run_deque * d)
+{
+    while (d->array != NULL)
+    {
+        _run_ring * retired = d->array->retired;
+        free (d->array);
+        d->array = retired;
+    }
+}
+
+void _run_deque_push (_run_deque * d, _run_task * task)
+{
+    long int b = __atomic_load_n (& d->bottom, __ATOMIC_RELAXED);
+    long int t = __atomic_load_n (& d->top, __ATOMIC_ACQUIRE);
+    _run_ring * a = __atomic_load_n (& d->array, __ATOMIC_RELAXED);
+
+    if (b - t > a->mask)
+    {
+        long int size = 2 * (a->mask + 1);
+        _run_ring * bigger = malloc (sizeof * bigger
+                + (size_t) size * sizeof * bigger->slots);
+        __forbid_value (bigger, NULL, "malloc", EX_OSERR);
+        bigger->mask = size - 1;
+        bigger->retired = a;
+        for (long int i = t; i < b; ++i)
+            __atomic_store_n (& bigger->slots[i & bigger->mask],
+                    __atomic_load_n (& a->slots[i & a->mask],
+                        __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        __atomic_store_n (& d->array, bigger, __ATOMIC_RELEASE);
+        a = bigger;
+    }
+
+    __atomic_store_n (& a->slots[b & a->mask], task, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    __atomic_store_n (& d->bottom, b + 1, __ATOMIC_RELAXED);
+}
+
+_run_task * _run_deque_pop (_run_deque * d)
+{
+    long int b = __atomic_load_n (& d->bottom, __ATOMIC_RELAXED) - 1;
+    _run_ring * a = __atomic_load_n (& d->array, __ATOMIC_RELAXED);
+    __atomic_store_n (& d->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    long int t = __atomic_load_n (& d->top, __ATOMIC_RELAXED);
+
+    _run_task * task = NULL;
+    if (t <= b)
+    {
+        task = __atomic_load_n (& a->slots[b & a->mask], __ATOMIC_RELAXED);
+        if (t == b)
+        {
+            /* Last one: race against the thieves. */
+            if (! __atomic_compare_exchange_n (& d->top, & t, t + 1, false,
+                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                task = NULL;
+            __atomic_store_n (& d->bottom, b + 1, __ATOMIC_RELAXED);
+        }
+    }
+    else
+        __atomic_store_n (& d->bottom, b + 1, __ATOMIC_RELAXED);
+
+    return task;
+}
+
+_run_task * _run_deque_steal (_run_deque * d)
+{
+    long int t = __atomic_load_n (& d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    long int b = __atomic_load_n (& d->bottom, __ATOMIC_ACQUIRE);
+
+    if (t >= b)
+        return NULL;
+
+    _run_ring * a = __atomic_load_n (& d->array, __ATOMIC_ACQUIRE);
+    _run_task * task = __atomic_load_n (& a->slots[t & a->mask],
+            __ATOMIC_RELAXED);
+    if (! __atomic_compare_exchange_n (& d->top, & t, t + 1, false,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return NULL;
+
+    return task;
+}
+
+_run_task * _run_find (_run_state * s)
+{
+    _run_worker * self = _run_current;
+    _run_task * task = NULL;
+    if (self != NULL && (task = _run_deque_pop (& self->tasks)) != NULL)
+        return task;
+
+    for (size_t attempt = 0; attempt < s->worker_count; ++attempt)
+    {
+        _run_seed ^= _run_seed << 13;
+        _run_seed ^= _run_seed >> 7;
+        _run_seed ^= _run_seed << 17;
+        _run_worker * victim = & s->workers[_run_seed % s->worker_count];
+        if (victim != self
+                && (task = _run_deque_steal (& victim->tasks)) != NULL)
+            return task;
+    }
+
+    if (__atomic_load_n (& s->shared, __ATOMIC_RELAXED) != NULL)
+    {
+        pthread_mutex_lock (& s->lock);
+        task = s->shared;
+        if (task != NULL)
+            __atomic_store_n (& s->shared, task->next, __ATOMIC_RELAXED);
+        pthread_mutex_unlock (& s->lock);
+    }
+
+    return task;
+}
+
+void _run_help (_run_state * s, unsigned int * idle)
+{
+    _run_task * task = _run_find (s);
+    if (task != NULL)
+    {
+        _run_task_execute (task);
+        * idle = 0;
+    }
+    else if (++ * idle > 64)
+        sched_yield ();
+}
+
+void * _run_worker_main (void * data)
+{
+    _run_worker * self = data;
+    _run_state * s = self->state;
+    _run_current = self;
+    _run_seed = 2654435761ul * (unsigned long int) (self - s->workers + 1);
+
+    unsigned int idle = 0;
+    while (! __atomic_load_n (& s->stop, __ATOMIC_ACQUIRE))
+        _run_help (s, & idle);
+
+    return NULL;
+}
+
+void * _run_thread_main (void * data)
+{
+    _run_seed = (unsigned long int) (uintptr_t) data | 1;
+    _run_task_execute (data);
+    return NULL;
+}
+
+void _run_wait (_run_state * s, _run_finish * f)
+{
+    unsigned int idle = 0;
+    while (__atomic_load_n (& f->pending, __ATOMIC_ACQUIRE) != 0)
+        _run_help (s, & idle);
+}
+
+void _run_phase (_run_state * s, bool clocked, unsigned long int registered)
+{
+    double now = _run_now ();
+
+    pthread_mutex_lock (& s->lock);
+    unsigned long int ended = __atomic_load_n (& s->activities,
+            __ATOMIC_ACQUIRE);
+
+    interpreter_stats * stats = s->stats;
+    if (stats->phase_count == stats->phase_size)
+    {
+        stats->phase_size = stats->phase_size == 0 ? 64 : 2 * stats->phase_size;
+        stats->phases = realloc (stats->phases,
+                stats->phase_size * sizeof * stats->phases);
+        __forbid_value (stats->phases, NULL, "realloc", EX_OSERR);
+    }
+
+    interpreter_phase * phase = & stats->phases[stats->phase_count++];
+    phase->seconds = now - s->last;
+    phase->activities = clocked ? registered : ended - s->ended;
+
+    s->last = now;
+    s->ended = ended;
+    pthread_mutex_unlock (& s->lock);
+}
+
+void _run_clock_next (_run_state * s, _run_clock * c, uint64_t state)
+{
+    if (c->main)
+        _run_phase (s, true, (unsigned long int) (state >> 32));
+
+    /* Every registered activity is waiting: nobody else touches the state. */
+    __atomic_store_n (& c->state, state - (state & (_run_one - 1)),
+            __ATOMIC_SEQ_CST);
+    __atomic_add_fetch (& c->phase, 1, __ATOMIC_SEQ_CST);
+}
+
+void _run_clock_advance (_run_state * s, _run_clock * c)
+{
+    unsigned long int phase = __atomic_load_n (& c->phase, __ATOMIC_SEQ_CST);
+    uint64_t state = __atomic_add_fetch (& c->state, 1, __ATOMIC_SEQ_CST);
+    if ((state & (_run_one - 1)) == state >> 32)
+        _run_clock_next (s, c, state);
+    else
+        for (unsigned int spin = 0;
+                __atomic_load_n (& c->phase, __ATOMIC_SEQ_CST) == phase; ++spin)
+            if (spin > 64)
+                sched_yield ();
+}
+
+void _run_clock_drop (_run_state * s, _run_clock * c)
+{
+    uint64_t state = __atomic_sub_fetch (& c->state, _run_one,
+            __ATOMIC_SEQ_CST);
+    uint64_t arrived = state & (_run_one - 1);
+    if (arrived > 0 && arrived == state >> 32)
+        _run_clock_next (s, c, state);
+}
+
+bool _run_kernel_resolve (_run_state * s, const char * identifier,
+        void * library)
+{
+    for (size_t k = 0; k < s->kernel_count; ++k)
+        if (strcmp (s->kernels[k].identifier, identifier) == 0)
+            return true;
+
+    /* A pointer to an object converted to a pointer to a function, as
+     * dlsym(3) suggests.
+     */
+    interpreter_kernel function = NULL;
+    if (library != NULL)
+    {
+        * (void **) (& function) = dlsym (library, identifier);
+        if (function == NULL)
+        {
+            fprintf (stderr, "Error: no function \"%s\" in the kernels.\n",
+                    identifier);
+            return false;
+        }
+    }
+
+    s->kernels = realloc (s->kernels,
+            (s->kernel_count + 1) * sizeof * s->kernels);
+    __forbid_value (s->kernels, NULL, "realloc", EX_OSERR);
+    s->kernels[s->kernel_count].identifier = identifier;
+    s->kernels[s->kernel_count].function = function;
+    ++s->kernel_count;
+
+    return true;
+}
+
+bool _run_kernels_resolve (_run_state * s, const instruction_list * list,
+        void * library)
+{
+    for (const instruction_list * l = list; l != NULL; l = l->next)
+    {
+        const instruction * instr = l->element;
+        if (instr == NULL)
+            continue;
+
+        bool found = true;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                found = _run_kernel_resolve (s, instr->content.call.identifier,
+                        library);
+                break;
+            case INSTR_FOR:
+                found = _run_kernels_resolve (s, instr->content.loop.body,
+                        library);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                found = _run_kernels_resolve (s,
+                        instr->content.branch.true_body, library)
+                    && (! instr->content.branch.has_else
+                        || _run_kernels_resolve (s,
+                            instr->content.branch.false_body, library));
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                found = _run_kernels_resolve (s, instr->content.block,
+                        library);
+                break;
+            default:
+                break;
+        }
+
+        if (! found)
+            return false;
+    }
+
+    return true;
+}
+
+void _run_bind (_run_activity * a, const char * identifier, long int value)
+{
+    if (a->length == a->size)
+    {
+        _run_binding * bindings = malloc (2 * a->size * sizeof * bindings);
+        __forbid_value (bindings, NULL, "malloc", EX_OSERR);
+        memcpy (bindings, a->bindings, a->length * sizeof * bindings);
+        if (a->bindings != a->room)
+            free (a->bindings);
+        a->bindings = bindings;
+        a->size *= 2;
+    }
+
+    a->bindings[a->length].identifier = identifier;
+    a->bindings[a->length].value = value;
+    ++a->length;
+}
+
+size_t _run_lookup (const _run_activity * a, const char * identifier)
+{
+    for (size_t i = a->length; i-- > 0; )
+        if (a->bindings[i].identifier == identifier
+                || strcmp (a->bindings[i].identifier, identifier) == 0)
+            return i;
+
+    fprintf (stderr, "Error: unknown identifier \"%s\".\n", identifier);
+    exit (EX_DATAERR);
+}
+
+long int _run_expression (const expression * e, const _run_activity * a)
+{
+    if (e == NULL)
+        return 0;
+
+    const expression * l = e->content.operands.left;
+    const expression * r = e->content.operands.right;
+    switch (e->type)
+    {
+        case EXPR_OR:
+            return _run_expression (l, a) || _run_expression (r, a);
+        case EXPR_AND:
+            return _run_expression (l, a) && _run_expression (r, a);
+        case EXPR_LT:
+            return _run_expression (l, a) < _run_expression (r, a);
+        case EXPR_GT:
+            return _run_expression (l, a) > _run_expression (r, a);
+        case EXPR_EQ:
+            return _run_expression (l, a) == _run_expression (r, a);
+        case EXPR_NE:
+            return _run_expression (l, a) != _run_expression (r, a);
+        case EXPR_LE:
+            return _run_expression (l, a) <= _run_expression (r, a);
+        case EXPR_GE:
+            return _run_expression (l, a) >= _run_expression (r, a);
+        case EXPR_ADD:
+            return _run_expression (l, a) + _run_expression (r, a);
+        case EXPR_SUB:
+            return _run_expression (l, a) - _run_expression (r, a);
+        case EXPR_MULT:
+            return _run_expression (l, a) * _run_expression (r, a);
+        case EXPR_DIV:
+        {
+            /* Rounded towards negative infinity, as in the ISL ASTs. */
+            long int n = _run_expression (l, a);
+            long int d = _run_expression (r, a);
+            if (d == 0)
+            {
+                fprintf (stderr, "Error: division by zero.\n");
+                exit (EX_DATAERR);
+            }
+            long int q = n / d;
+            return n % d != 0 && (n < 0) != (d < 0) ? q - 1 : q;
+        }
+        case EXPR_MIN:
+        {
+            long int x = _run_expression (l, a);
+            long int y = _run_expression (r, a);
+            return x < y ? x : y;
+        }
+        case EXPR_MAX:
+        {
+            long int x = _run_expression (l, a);
+            long int y = _run_expression (r, a);
+            return x > y ? x : y;
+        }
+        case EXPR_NOT:
+            return ! _run_expression (l, a);
+        case EXPR_NEG:
+            return - _run_expression (l, a);
+        case EXPR_ID:
+            return a->bindings[_run_lookup (a, e->content.identifier)].value;
+        case EXPR_NUMBER:
+            return e->content.number;
+        case EXPR_TRUE:
+            return 1;
+        case EXPR_FALSE:
+        default:
+            return 0;
+    }
+}
+
+void _run_block (const instruction_list * list, _run_activity * a)
+{
+    size_t length = a->length;
+    for (const instruction_list * l = list; l != NULL; l = l->next)
+        _run_instruction (l->element, a);
+    a->length = length;
+}
+
+void _run_finish_block (const instruction * instr, _run_activity * a)
+{
+    bool clocked = instr->type == INSTR_CLOCKED_FINISH;
+    _run_finish * enclosing_finish = a->finish;
+    _run_clock * enclosing_clock = a->clock;
+
+    /* The body of a clocked finish is registered until it ends. */
+    _run_finish finish = { 0 };
+    _run_clock clock = { _run_one, 0, a->main };
+    a->finish = & finish;
+    if (clocked)
+        a->clock = & clock;
+
+    _run_block (instr->content.block, a);
+
+    if (clocked)
+        _run_clock_drop (a->state, & clock);
+    _run_wait (a->state, & finish);
+
+    a->finish = enclosing_finish;
+    a->clock = enclosing_clock;
+
+    if (a->main)
+        _run_phase (a->state, false, 0);
+}
+
+void _run_spawn (const instruction * instr, _run_activity * a)
+{
+    _run_task * task = malloc (sizeof * task
+            + a->length * sizeof * task->bindings);
+    __forbid_value (task, NULL, "malloc", EX_OSERR);
+    task->state = a->state;
+    task->body = instr->content.block;
+    task->finish = a->finish;
+    task->clock = instr->type == INSTR_CLOCKED_ASYNC ? a->clock : NULL;
+    task->next = NULL;
+    task->length = a->length;
+    memcpy (task->bindings, a->bindings, a->length * sizeof * a->bindings);
+
+    __atomic_add_fetch (& a->finish->pending, 1, __ATOMIC_RELAXED);
+
+    /* Clocked asyncs block until the end of their phases: they get threads
+     * of their own, lest they starve the pool.
+     */
+    if (task->clock != NULL)
+    {
+        __atomic_add_fetch (& task->clock->state, _run_one, __ATOMIC_SEQ_CST);
+
+        pthread_t thread;
+        pthread_attr_t attributes;
+        pthread_attr_init (& attributes);
+        pthread_attr_setdetachstate (& attributes, PTHREAD_CREATE_DETACHED);
+        if (pthread_create (& thread, & attributes, _run_thread_main, task))
+        {
+            perror ("pthread_create");
+            exit (EX_OSERR);
+        }
+        pthread_attr_destroy (& attributes);
+        return;
+    }
+
+    _run_worker * self = _run_current;
+    if (self == NULL)
+    {
+        pthread_mutex_lock (& a->state->lock);
+        task->next = a->state->shared;
+        __atomic_store_n (& a->state->shared, task, __ATOMIC_RELAXED);
+        pthread_mutex_unlock (& a->state->lock);
+    }
+    else if (__atomic_load_n (& self->tasks.bottom, __ATOMIC_RELAXED)
+            - __atomic_load_n (& self->tasks.top, __ATOMIC_RELAXED)
+            >= _run_cutoff)
+        _run_task_execute (task);
+    else
+        _run_deque_push (& self->tasks, task);
+}
+
+void _run_task_execute (_run_task * task)
+{
+    _run_activity a;
+    a.state = task->state;
+    a.finish = task->finish;
+    a.clock = task->clock;
+    a.main = false;
+    a.length = 0;
+    a.size = sizeof a.room / sizeof * a.room;
+    a.bindings = a.room;
+    a.calls = 0;
+    for (size_t i = 0; i < task->length; ++i)
+        _run_bind (& a, task->bindings[i].identifier, task->bindings[i].value);
+
+    _run_block (task->body, & a);
+
+    if (a.clock != NULL)
+        _run_clock_drop (a.state, a.clock);
+    if (a.bindings != a.room)
+        free (a.bindings);
+
+    /* The finish may end as soon as it is left: it comes last. */
+    _run_finish * finish = task->finish;
+    __atomic_add_fetch (& a.state->calls, a.calls, __ATOMIC_RELAXED);
+    __atomic_add_fetch (& a.state->activities, 1, __ATOMIC_RELEASE);
+    free (task);
+    __atomic_sub_fetch (& finish->pending, 1, __ATOMIC_RELEASE);
+}
+
+void _run_instruction (const instruction * instr, _run_activity * a)
+{
+    if (instr == NULL)
+        return;
+
+    switch (instr->type)
+    {
+        case INSTR_CALL:
+        {
+            size_t count = 0;
+            for (const expression_list * l = instr->content.call.arguments;
+                    l != NULL; l = l->next)
+                ++count;
+
+            long int arguments[count + 1];
+            count = 0;
+            for (const expression_list * l = instr->content.call.arguments;
+                    l != NULL; l = l->next)
+                arguments[count++] = _run_expression (l->element, a);
+
+            const char * identifier = instr->content.call.identifier;
+            const _run_kernel * k = a->state->kernels;
+            while (strcmp (k->identifier, identifier) != 0)
+                ++k;
+            if (k->function != NULL)
+                k->function (arguments, (int) count);
+            ++a->calls;
+            break;
+        }
+        case INSTR_FOR:
+        {
+            /* The boundaries are evaluated once. */
+            long int left = _run_expression (instr->content.loop.left_boundary,
+                    a);
+            long int right = _run_expression (
+                    instr->content.loop.right_boundary, a);
+
+            size_t iterator = a->length;
+            _run_bind (a, instr->content.loop.identifier, left);
+            for (long int i = left; i <= right; ++i)
+            {
+                a->bindings[iterator].value = i;
+                _run_block (instr->content.loop.body, a);
+            }
+            a->length = iterator;
+            break;
+        }
+        case INSTR_IF:
+        case INSTR_IF_ELSE:
+            if (_run_expression (instr->content.branch.condition, a))
+                _run_block (instr->content.branch.true_body, a);
+            else if (instr->content.branch.has_else)
+                _run_block (instr->content.branch.false_body, a);
+            break;
+        case INSTR_VAL:
+        case INSTR_VAR:
+            _run_bind (a, instr->content.bind.identifier,
+                    _run_expression (instr->content.bind.value, a));
+            break;
+        case INSTR_ASSIGN:
+        {
+            long int value = _run_expression (instr->content.bind.value, a);
+            a->bindings[_run_lookup (a, instr->content.bind.identifier)].value
+                = value;
+            break;
+        }
+        case INSTR_ADVANCE:
+            if (a->clock != NULL)
+                _run_clock_advance (a->state, a->clock);
+            break;
+        case INSTR_FINISH:
+        case INSTR_CLOCKED_FINISH:
+            _run_finish_block (instr, a);
+            break;
+        case INSTR_ASYNC:
+        case INSTR_CLOCKED_ASYNC:
+            _run_spawn (instr, a);
+            break;
+        default:
+            break;
+    }
+}
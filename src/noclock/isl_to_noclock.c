@@ -90,6 +90,17 @@ static expression * isl_init_to_expr (isl_ast_expr * expr);
  */
 static expression * isl_cond_to_expr (isl_ast_expr * expr);
 
+/**
+ * \brief Replace an identifier by an expression in an AST.
+ * \since version `1.1.0`
+ *
+ * \param list AST (modified).
+ * \param identifier Identifier to replace.
+ * \param value Replacement (copied).
+ */
+static void substitute_list (instruction_list * list, const char * identifier,
+        const expression * value);
+
 ////////////////////////////////////////////////////////////////////////////////
 // ISL -> No Clock.
 ////////////////////////////////////////////////////////////////////////////////
@@ -102,15 +113,17 @@ expression * isl_expr_to_noclock_expr (isl_ast_expr * expr)
 
     if (expr_t == isl_ast_expr_id)
     {
-        e = expression_from_identifier (isl_id_get_name (
-                    isl_ast_expr_get_id (expr)));
+        isl_id * id = isl_ast_expr_get_id (expr);
+        e = expression_from_identifier (isl_id_get_name (id));
+        isl_id_free (id);
 
         return e;
     }
     else if (expr_t == isl_ast_expr_int)
     {
-        e = expression_from_number (
-                isl_val_get_num_si (isl_ast_expr_get_val (expr)));
+        isl_val * val = isl_ast_expr_get_val (expr);
+        e = expression_from_number (isl_val_get_num_si (val));
+        isl_val_free (val);
 
         return e;
     }
@@ -152,11 +165,28 @@ expression * isl_expr_to_noclock_expr (isl_ast_expr * expr)
         case isl_ast_op_div:
         case isl_ast_op_fdiv_q:
         case isl_ast_op_pdiv_q:
-        case isl_ast_op_pdiv_r:
             e = expression_alloc ();
             expression_set_type (e, EXPR_DIV);
             binary = true;
             break;
+        case isl_ast_op_pdiv_r:
+        case isl_ast_op_zdiv_r:
+        {
+            /* a - b * (a / b), with the division rounding towards negative
+             * infinity: the remainder when a >= 0, and 0 exactly when b
+             * divides a, which is all ISL asks of them.
+             */
+            isl_ast_expr * left = isl_ast_expr_get_op_arg (expr, 0);
+            isl_ast_expr * right = isl_ast_expr_get_op_arg (expr, 1);
+            expression * a = isl_expr_to_noclock_expr (left);
+            expression * b = isl_expr_to_noclock_expr (right);
+            isl_ast_expr_free (left);
+            isl_ast_expr_free (right);
+
+            return expression_sub (expression_copy (a),
+                    expression_mult (expression_copy (b),
+                        expression_div (a, b)));
+        }
         case isl_ast_op_member:
         case isl_ast_op_cond:
         case isl_ast_op_select:
@@ -207,17 +237,16 @@ expression * isl_expr_to_noclock_expr (isl_ast_expr * expr)
             break;
     }
 
+    /* The operands are owned references: release them once converted. */
+    isl_ast_expr * left = isl_ast_expr_get_op_arg (expr, 0);
+    expression_set_left_operand (e, isl_expr_to_noclock_expr (left));
+    isl_ast_expr_free (left);
+
     if (binary)
     {
-        expression_set_left_operand (e,
-                isl_expr_to_noclock_expr (isl_ast_expr_get_op_arg (expr, 0)));
-        expression_set_right_operand (e,
-                isl_expr_to_noclock_expr (isl_ast_expr_get_op_arg (expr, 1)));
-    }
-    else
-    {
-        expression_set_left_operand (e,
-                isl_expr_to_noclock_expr (isl_ast_expr_get_op_arg (expr, 0)));
+        isl_ast_expr * right = isl_ast_expr_get_op_arg (expr, 1);
+        expression_set_right_operand (e, isl_expr_to_noclock_expr (right));
+        isl_ast_expr_free (right);
     }
 
     return e;
@@ -262,8 +291,12 @@ instruction_list * isl_for_to_noclock (isl_ast_node * for_node)
     isl_id * id = isl_ast_expr_get_id (iterator);
     isl_ast_expr * init = isl_ast_node_for_get_init (for_node);
     isl_ast_expr * cond = isl_ast_node_for_get_cond (for_node);
+    isl_ast_expr * inc = isl_ast_node_for_get_inc (for_node);
     isl_ast_node * body = isl_ast_node_for_get_body (for_node);
 
+    isl_val * step_val = isl_ast_expr_get_val (inc);
+    long int step = isl_val_get_num_si (step_val);
+    isl_val_free (step_val);
 
     /* Construct the for loop. */
     instruction * loop = instruction_for_loop (
@@ -272,6 +305,36 @@ instruction_list * isl_for_to_noclock (isl_ast_node * for_node)
             isl_cond_to_expr (cond),
             isl_ast_to_noclock_ast (body));
 
+    /* NoClock loops have no step: a loop over (lo..hi) by step s becomes a
+     * loop over (0..floord (hi - lo, s)), where the iterator i stands for
+     * lo + s * i. The division rounds towards negative infinity (it is
+     * printed as floord, not as X10's /): when hi < lo, the bound is negative
+     * and the loop stays empty.
+     */
+    if (step > 1)
+    {
+        expression * lo = loop->content.loop.left_boundary;
+        expression * hi = loop->content.loop.right_boundary;
+        expression * value = expression_add (expression_copy (lo),
+                expression_mult (expression_from_number (step),
+                    expression_from_identifier (loop->content.loop.identifier)));
+        substitute_list (loop->content.loop.body,
+                loop->content.loop.identifier, value);
+        expression_free (value);
+
+        loop->content.loop.left_boundary = expression_from_number (0);
+        loop->content.loop.right_boundary = expression_div (
+                expression_sub (hi, lo), expression_from_number (step));
+    }
+
+    /* Every getter above returned a copy: release them. */
+    isl_ast_node_free (body);
+    isl_ast_expr_free (inc);
+    isl_ast_expr_free (cond);
+    isl_ast_expr_free (init);
+    isl_id_free (id);
+    isl_ast_expr_free (iterator);
+
     /* Wrap the loop in an instruction list node. */
     instruction_list * list = instruction_list_alloc ();
     list->element = loop;
@@ -299,6 +362,7 @@ instruction_list * isl_if_to_noclock (isl_ast_node * if_node)
         if_i->content.branch.false_body =
             isl_ast_to_noclock_ast (else_body);
         if_i->content.branch.has_else = true;
+        isl_ast_node_free (else_body);
     }
 
     /* Wrap the if then else in an instruction list node. */
@@ -306,6 +370,9 @@ instruction_list * isl_if_to_noclock (isl_ast_node * if_node)
     list->element = if_i;
     list->next = NULL;
 
+    isl_ast_node_free (if_body);
+    isl_ast_expr_free (cond);
+
     return list;
 }
 
@@ -321,8 +388,11 @@ instruction_list * isl_block_to_noclock (isl_ast_node * block_node)
         isl_ast_node * current = isl_ast_node_list_get_ast_node (children, i);
         instruction_list * instr = isl_ast_to_noclock_ast (current);
         list = instruction_list_cat (list, instr);
+        isl_ast_node_free (current);
     }
 
+    isl_ast_node_list_free (children);
+
     return list;
 }
 
@@ -330,20 +400,30 @@ instruction_list * isl_user_to_noclock (isl_ast_node * user_node)
 {
     isl_ast_expr * expr = isl_ast_node_user_get_expr (user_node);
 
+    isl_ast_expr * callee = isl_ast_expr_get_op_arg (expr, 0);
+    isl_id * id = isl_ast_expr_get_id (callee);
+
     instruction * user = instruction_alloc ();
     user->type = INSTR_CALL;
-    user->content.call.identifier = strdup (isl_id_get_name (
-                isl_ast_expr_get_id (isl_ast_expr_get_op_arg (expr, 0))));
+    user->content.call.identifier = strdup (isl_id_get_name (id));
+    user->annotation.origin = isl_id_get_user (id);
+
+    isl_id_free (id);
+    isl_ast_expr_free (callee);
 
     for (int i = 1; i < isl_ast_expr_get_op_n_arg (expr); ++i)
     {
+        isl_ast_expr * arg = isl_ast_expr_get_op_arg (expr, i);
         expression_list * e = expression_list_alloc ();
-        e->element = isl_expr_to_noclock_expr (isl_ast_expr_get_op_arg (expr, i));
+        e->element = isl_expr_to_noclock_expr (arg);
         e->next = NULL;
         user->content.call.arguments = expression_list_cat (
                 user->content.call.arguments, e);
+        isl_ast_expr_free (arg);
     }
 
+    isl_ast_expr_free (expr);
+
     instruction_list * list = instruction_list_alloc ();
     list->element = user;
     list->next = NULL;
@@ -361,7 +441,9 @@ expression * isl_cond_to_expr (isl_ast_expr * expr)
     expression * result;
     enum isl_ast_op_type t = isl_ast_expr_get_op_type (expr);
 
-    result = isl_expr_to_noclock_expr (isl_ast_expr_get_op_arg (expr, 1));
+    isl_ast_expr * bound = isl_ast_expr_get_op_arg (expr, 1);
+    result = isl_expr_to_noclock_expr (bound);
+    isl_ast_expr_free (bound);
 
     if (t == isl_ast_op_lt)
     {
@@ -376,3 +458,58 @@ expression * isl_cond_to_expr (isl_ast_expr * expr)
 
     return result;
 }
+
+void substitute_list (instruction_list * list, const char * identifier,
+        const expression * value)
+{
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                for (expression_list * a = instr->content.call.arguments;
+                        a != NULL; a = a->next)
+                {
+                    expression * e = a->element;
+                    a->element = expression_substitute (e, identifier, value);
+                    expression_free (e);
+                }
+                break;
+            case INSTR_FOR:
+            {
+                expression * left = instr->content.loop.left_boundary;
+                expression * right = instr->content.loop.right_boundary;
+                instr->content.loop.left_boundary =
+                    expression_substitute (left, identifier, value);
+                instr->content.loop.right_boundary =
+                    expression_substitute (right, identifier, value);
+                expression_free (left);
+                expression_free (right);
+
+                if (strcmp (instr->content.loop.identifier, identifier))
+                    substitute_list (instr->content.loop.body, identifier,
+                            value);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+            {
+                expression * condition = instr->content.branch.condition;
+                instr->content.branch.condition =
+                    expression_substitute (condition, identifier, value);
+                expression_free (condition);
+
+                substitute_list (instr->content.branch.true_body, identifier,
+                        value);
+                if (instr->content.branch.has_else)
+                    substitute_list (instr->content.branch.false_body,
+                            identifier, value);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,277 @@
+/**
+ * \file peephole.c
+ * \brief Peephole optimizations of NoClock ASTs.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "noclock/peephole.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Static variables.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Rule names.
+ * \since version `1.1.0`
+ */
+static const char * peephole_rule_strings[] =
+{
+    [PEEPHOLE_FINISH_ASYNC] = "finish-async",
+    [PEEPHOLE_ASYNC_ASYNC]  = "async-async",
+    [PEEPHOLE_FINISH_SYNC]  = "finish-sync",
+    [PEEPHOLE_FINISH_MERGE] = "finish-merge",
+    [PEEPHOLE_UNKNOWN]      = "",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Apply the rules once, from the innermost blocks.
+ * \since version `1.1.0`
+ *
+ * \param list Pointer to the list to optimize.
+ * \param stats Counters to increment.
+ * \return Whether a rule has been applied.
+ */
+static bool _peephole (instruction_list ** list, peephole_stats * stats);
+
+/**
+ * \brief Check whether an AST spawns activities.
+ * \since version `1.1.0`
+ *
+ * \param list Input AST.
+ * \return Whether an async appears in \p list.
+ */
+static bool _spawns (const instruction_list * list);
+
+/**
+ * \brief Get the only instruction of a block, if it is an async.
+ * \since version `1.1.0`
+ *
+ * \param block Block.
+ * \return The async, or `NULL`.
+ */
+static instruction * _only_async (const instruction_list * block);
+
+/**
+ * \brief Count a rule application.
+ * \since version `1.1.0`
+ *
+ * \param stats Counters.
+ * \param rule Applied rule.
+ */
+static inline void _count (peephole_stats * stats, peephole_rule rule);
+
+////////////////////////////////////////////////////////////////////////////////
+// Optimizations.
+////////////////////////////////////////////////////////////////////////////////
+
+instruction_list * instruction_list_peephole (instruction_list * list,
+        peephole_stats * stats)
+{
+    while (_peephole (& list, stats))
+        ;
+    return list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+void peephole_stats_fprint (FILE * f, const peephole_stats * stats)
+{
+    for (peephole_rule r = 0; r < PEEPHOLE_UNKNOWN; ++r)
+        fprintf (f, "%-16s%zu\n", peephole_rule_strings[r], stats->count[r]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+bool _peephole (instruction_list ** list, peephole_stats * stats)
+{
+    bool changed = false;
+
+    instruction_list ** node = list;
+    while (* node != NULL)
+    {
+        instruction * instr = (* node)->element;
+
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                changed |= _peephole (& instr->content.loop.body, stats);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                changed |= _peephole (& instr->content.branch.true_body,
+                        stats);
+                if (instr->content.branch.has_else)
+                    changed |= _peephole (& instr->content.branch.false_body,
+                            stats);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                changed |= _peephole (& instr->content.block, stats);
+                break;
+            default:
+                break;
+        }
+
+        if (instr->type != INSTR_FINISH && instr->type != INSTR_ASYNC)
+        {
+            node = & (* node)->next;
+            continue;
+        }
+
+        /* finish { async { X } } => finish { X }
+         * async { async { X } } => async { X }
+         */
+        instruction * inner = _only_async (instr->content.block);
+        if (inner != NULL)
+        {
+            instruction_list * block = instr->content.block;
+            instr->content.block = inner->content.block;
+            inner->content.block = NULL;
+            instruction_list_free (block);
+
+            _count (stats, instr->type == INSTR_FINISH
+                    ? PEEPHOLE_FINISH_ASYNC : PEEPHOLE_ASYNC_ASYNC);
+            changed = true;
+            continue;
+        }
+
+        /* finish { X } => X, when X runs synchronously. */
+        if (instr->type == INSTR_FINISH && ! _spawns (instr->content.block))
+        {
+            instruction_list * finish = * node;
+            instruction_list * block = instr->content.block;
+            instr->content.block = NULL;
+
+            instruction_list * last = block;
+            if (last != NULL)
+            {
+                while (last->next != NULL)
+                    last = last->next;
+                last->next = finish->next;
+                * node = block;
+            }
+            else
+                * node = finish->next;
+
+            instruction_free (instr);
+            free (finish);
+
+            _count (stats, PEEPHOLE_FINISH_SYNC);
+            changed = true;
+            continue;
+        }
+
+        /* finish { A } finish { B } => finish { A B }, within a phase of a
+         * same clocked finish.
+         */
+        instruction_list * next = (* node)->next;
+        if (instr->type == INSTR_FINISH && next != NULL
+            && next->element->type == INSTR_FINISH
+            && instr->annotation.date != NULL
+            && instr->annotation.origin != NULL
+            && instr->annotation.origin == next->element->annotation.origin
+            && expression_equal (instr->annotation.date,
+                next->element->annotation.date))
+        {
+            instr->content.block = instruction_list_cat (instr->content.block,
+                    next->element->content.block);
+            next->element->content.block = NULL;
+            (* node)->next = next->next;
+            next->next = NULL;
+            instruction_list_free (next);
+
+            _count (stats, PEEPHOLE_FINISH_MERGE);
+            changed = true;
+            continue;
+        }
+
+        node = & (* node)->next;
+    }
+
+    return changed;
+}
+
+bool _spawns (const instruction_list * list)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_ASYNC:
+                return true;
+            case INSTR_FOR:
+                if (_spawns (instr->content.loop.body))
+                    return true;
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                if (_spawns (instr->content.branch.true_body)
+                    || (instr->content.branch.has_else
+                        && _spawns (instr->content.branch.false_body)))
+                    return true;
+                break;
+            case INSTR_FINISH:
+            case INSTR_CLOCKED_FINISH:
+                /* Activities spawned inside are waited for. */
+                break;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+instruction * _only_async (const instruction_list * block)
+{
+    if (block == NULL || block->next != NULL
+        || block->element->type != INSTR_ASYNC)
+        return NULL;
+    return block->element;
+}
+
+void _count (peephole_stats * stats, peephole_rule rule)
+{
+    if (stats != NULL)
+        ++stats->count[rule];
+}
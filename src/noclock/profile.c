@@ -0,0 +1,115 @@
+/**
+ * \file profile.c
+ * \brief Times of the statements, measured by a training run.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/profile.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Init, clean.
+////////////////////////////////////////////////////////////////////////////////
+
+void profile_init (profile * p)
+{
+    string_list_init (& p->statements);
+    p->times = NULL;
+}
+
+void profile_clean (profile * p)
+{
+    string_list_clean (& p->statements);
+    free (p->times);
+    p->times = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Input/Output.
+////////////////////////////////////////////////////////////////////////////////
+
+size_t profile_fscan (profile * p, FILE * f)
+{
+    char * line = NULL;
+    size_t size = 0;
+    size_t number = 0;
+    size_t malformed = 0;
+
+    while (malformed == 0 && getline (& line, & size, f) != -1)
+    {
+        ++number;
+
+        char * statement = strtok (line, " \t\n");
+        if (statement == NULL || statement[0] == '#')
+            continue;
+
+        char * value = strtok (NULL, " \t\n");
+        char * end = value;
+        double time = value != NULL ? strtod (value, & end) : 0;
+        if (end == value || * end != '\0' || time < 0
+            || strtok (NULL, " \t\n") != NULL)
+        {
+            malformed = number;
+            continue;
+        }
+
+        size_t s = 0;
+        while (s < p->statements.length
+            && strcmp (p->statements.list[s], statement) != 0)
+            ++s;
+        if (s == p->statements.length)
+        {
+            string_list_append (& p->statements, statement);
+            p->times = realloc (p->times,
+                    p->statements.length * sizeof * p->times);
+            __forbid_value (p->times, NULL, "realloc", EX_OSERR);
+        }
+        p->times[s] = time;
+    }
+
+    free (line);
+    return malformed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Getters.
+////////////////////////////////////////////////////////////////////////////////
+
+bool profile_time (const profile * p, const char * statement, double * time)
+{
+    for (size_t s = 0; s < p->statements.length; ++s)
+        if (strcmp (p->statements.list[s], statement) == 0)
+        {
+            * time = p->times[s];
+            return true;
+        }
+
+    return false;
+}
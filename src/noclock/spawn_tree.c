@@ -0,0 +1,186 @@
+/**
+ * \file spawn_tree.c
+ * \brief Divide-and-conquer spawning of parallel loops.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "noclock/spawn_tree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Replace a loop whose body is a single async by a spawn tree.
+ * \since version `1.1.0`
+ *
+ * \param current The list node holding the loop (modified).
+ * \param depth Depth of the tree.
+ */
+static void _spawn_tree_loop (instruction_list * current, unsigned int depth);
+
+/**
+ * \brief Boundary between two leaves of a spawn tree.
+ * \since version `1.1.0`
+ *
+ * \param lo Left boundary of the loop.
+ * \param hi Right boundary of the loop.
+ * \param leaf Index of the leaf starting at the boundary.
+ * \param leaves Number of leaves.
+ *
+ * \pre leaf < leaves
+ * \return `lo + (leaf * (hi - lo + 1)) / leaves`.
+ */
+static expression * _boundary (const expression * lo, const expression * hi,
+        unsigned long int leaf, unsigned long int leaves);
+
+/**
+ * \brief Build the instructions spawning the iterations of some leaves.
+ * \since version `1.1.0`
+ *
+ * \param loop The original loop.
+ * \param first Index of the first leaf.
+ * \param count Number of leaves.
+ * \param leaves Total number of leaves.
+ * \return The instructions.
+ */
+static instruction_list * _split (const instruction * loop,
+        unsigned long int first, unsigned long int count,
+        unsigned long int leaves);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_spawn_tree (instruction_list * list, unsigned int depth)
+{
+    if (depth == 0)
+        return;
+
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+            {
+                instruction_list_spawn_tree (instr->content.loop.body, depth);
+
+                instruction_list * body = instr->content.loop.body;
+                if (body != NULL && body->next == NULL
+                    && body->element->type == INSTR_ASYNC)
+                    _spawn_tree_loop (current, depth);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                instruction_list_spawn_tree (instr->content.branch.true_body,
+                        depth);
+                if (instr->content.branch.has_else)
+                    instruction_list_spawn_tree (
+                            instr->content.branch.false_body, depth);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instruction_list_spawn_tree (instr->content.block, depth);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _spawn_tree_loop (instruction_list * current, unsigned int depth)
+{
+    instruction * loop = current->element;
+    expression * lo = loop->content.loop.left_boundary;
+    expression * hi = loop->content.loop.right_boundary;
+
+    /* Do not split known ranges below one iteration per leaf. */
+    if (expression_is_number (lo) && expression_is_number (hi))
+    {
+        long int trips = expression_get_number (hi)
+            - expression_get_number (lo) + 1;
+        unsigned int max_depth = 0;
+        while (max_depth < depth && (2L << max_depth) <= trips)
+            ++max_depth;
+        depth = max_depth;
+    }
+
+    if (depth == 0)
+        return;
+
+    current->element = instruction_async (_split (loop, 0, 1UL << depth,
+                1UL << depth));
+    instruction_free (loop);
+}
+
+expression * _boundary (const expression * lo, const expression * hi,
+        unsigned long int leaf, unsigned long int leaves)
+{
+    expression * size = expression_add (expression_sub (expression_copy (hi),
+                expression_copy (lo)), expression_from_number (1));
+    return expression_add (expression_copy (lo), expression_div (
+                expression_mult (expression_from_number ((long int) leaf),
+                    size),
+                expression_from_number ((long int) leaves)));
+}
+
+instruction_list * _split (const instruction * loop, unsigned long int first,
+        unsigned long int count, unsigned long int leaves)
+{
+    if (count == 1)
+    {
+        const expression * lo = loop->content.loop.left_boundary;
+        const expression * hi = loop->content.loop.right_boundary;
+        char * identifier = strdup (loop->content.loop.identifier);
+        __forbid_value (identifier, NULL, "strdup", EX_OSERR);
+        return instruction_list_append (NULL, instruction_for_loop (identifier,
+                    _boundary (lo, hi, first, leaves),
+                    first + 1 == leaves ? expression_copy (hi)
+                        : expression_sub (_boundary (lo, hi, first + 1, leaves),
+                            expression_from_number (1)),
+                    instruction_list_copy (loop->content.loop.body)));
+    }
+
+    /* The first half is spawned, the second one is run by the spawner. */
+    unsigned long int half = count / 2;
+    instruction_list * first_half = _split (loop, first, half, leaves);
+    return instruction_list_cat (
+            instruction_list_append (NULL, instruction_async (first_half)),
+            _split (loop, first + half, count - half, leaves));
+}
@@ -0,0 +1,456 @@
+/**
+ * \file specialize.c
+ * \brief Replace parameters by their values and unroll short loops.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/specialize.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief The parameters to replace.
+ * \since version `1.1.0`
+ */
+typedef struct _context
+{
+    const string_list * names;      /**< The parameters. */
+    const long int * values;        /**< Their values. */
+    size_t * hidden;                /**< Loops hiding each parameter. */
+} _context;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Find a visible parameter.
+ * \since version `1.1.0`
+ *
+ * \param c Context.
+ * \param identifier Identifier.
+ * \return Its index, or `-1`.
+ */
+static ssize_t _find (const _context * c, const char * identifier);
+
+/**
+ * \brief Specialize and fold an expression.
+ * \since version `1.1.0`
+ *
+ * \param e Expression.
+ * \param c Context.
+ * \return A new expression.
+ */
+static expression * _expression (const expression * e, const _context * c);
+
+/**
+ * \brief Specialize an expression in place.
+ * \since version `1.1.0`
+ *
+ * \param e Expression (replaced).
+ * \param c Context.
+ */
+static void _replace (expression ** e, const _context * c);
+
+/**
+ * \brief Specialize each expression of a list.
+ * \since version `1.1.0`
+ *
+ * \param list Expressions (modified).
+ * \param c Context.
+ */
+static void _replace_list (expression_list * list, const _context * c);
+
+/**
+ * \brief Specialize instructions.
+ * \since version `1.1.0`
+ *
+ * \param list Instructions (modified).
+ * \param c Context.
+ * \return The instructions, without the branches never taken.
+ */
+static instruction_list * _specialize (instruction_list * list,
+        const _context * c);
+
+/**
+ * \brief Unroll the short loops of instructions.
+ * \since version `1.1.0`
+ *
+ * \param list Instructions (modified).
+ * \param limit Maximum number of iterations of an unrolled loop.
+ * \return The instructions, with one copy of the body of each unrolled loop
+ *         per iteration.
+ */
+static instruction_list * _unroll (instruction_list * list,
+        unsigned long int limit);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+instruction_list * instruction_list_specialize (instruction_list * list,
+        const string_list * names, const long int * values)
+{
+    if (names->length == 0)
+        return list;
+
+    size_t hidden[names->length];
+    memset (hidden, 0, sizeof hidden);
+    _context c = { .names = names, .values = values, .hidden = hidden, };
+
+    return _specialize (list, & c);
+}
+
+instruction_list * instruction_list_unroll (instruction_list * list,
+        unsigned long int limit)
+{
+    return limit > 0 ? _unroll (list, limit) : list;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+ssize_t _find (const _context * c, const char * identifier)
+{
+    for (size_t p = 0; p < c->names->length; ++p)
+        if (c->hidden[p] == 0 && strcmp (c->names->list[p], identifier) == 0)
+            return (ssize_t) p;
+
+    return -1;
+}
+
+expression * _expression (const expression * e, const _context * c)
+{
+    if (e == NULL)
+        return NULL;
+
+    switch (e->type)
+    {
+        case EXPR_ID:
+        {
+            ssize_t p = _find (c, e->content.identifier);
+            return p >= 0 ? expression_from_number (c->values[p])
+                : expression_copy (e);
+        }
+        case EXPR_NUMBER:
+        case EXPR_TRUE:
+        case EXPR_FALSE:
+        case EXPR_UNKNOWN:
+            return expression_copy (e);
+        default:
+            break;
+    }
+
+    expression * l = _expression (e->content.operands.left, c);
+    expression * r = _expression (e->content.operands.right, c);
+
+    /* Comparisons of numbers. */
+    if (expression_is_number (l) && expression_is_number (r)
+        && e->type >= EXPR_LT && e->type <= EXPR_GE)
+    {
+        long int a = expression_get_number (l);
+        long int b = expression_get_number (r);
+        expression_free (l);
+        expression_free (r);
+
+        switch (e->type)
+        {
+            case EXPR_LT:
+                return expression_from_boolean (a < b);
+            case EXPR_GT:
+                return expression_from_boolean (a > b);
+            case EXPR_EQ:
+                return expression_from_boolean (a == b);
+            case EXPR_NE:
+                return expression_from_boolean (a != b);
+            case EXPR_LE:
+                return expression_from_boolean (a <= b);
+            default:
+                return expression_from_boolean (a >= b);
+        }
+    }
+
+    /* Conjunctions and disjunctions with a constant. */
+    if ((e->type == EXPR_AND || e->type == EXPR_OR)
+        && (expression_is_boolean (l) || expression_is_boolean (r)))
+    {
+        expression * constant = expression_is_boolean (l) ? l : r;
+        expression * other = constant == l ? r : l;
+        bool absorbs = expression_get_boolean (constant) == (e->type == EXPR_OR);
+
+        if (absorbs)
+        {
+            expression_free (other);
+            return constant;
+        }
+        expression_free (constant);
+        return other;
+    }
+
+    switch (e->type)
+    {
+        case EXPR_NOT:
+            if (expression_is_boolean (l))
+            {
+                bool b = expression_get_boolean (l);
+                expression_free (l);
+                return expression_from_boolean (! b);
+            }
+            return expression_not (l);
+        case EXPR_NEG:
+            if (expression_is_number (l))
+            {
+                long int n = expression_get_number (l);
+                expression_free (l);
+                return expression_from_number (-n);
+            }
+            return expression_neg (l);
+        case EXPR_ADD:
+            return expression_add (l, r);
+        case EXPR_SUB:
+            return expression_sub (l, r);
+        case EXPR_MULT:
+            return expression_mult (l, r);
+        case EXPR_DIV:
+            return expression_div (l, r);
+        case EXPR_MIN:
+            return expression_min (l, r);
+        case EXPR_MAX:
+            return expression_max (l, r);
+        case EXPR_OR:
+            return expression_or (l, r);
+        case EXPR_AND:
+            return expression_and (l, r);
+        case EXPR_LT:
+            return expression_lt (l, r);
+        case EXPR_GT:
+            return expression_gt (l, r);
+        case EXPR_EQ:
+            return expression_eq (l, r);
+        case EXPR_NE:
+            return expression_ne (l, r);
+        case EXPR_LE:
+            return expression_le (l, r);
+        default:
+            return expression_ge (l, r);
+    }
+}
+
+void _replace (expression ** e, const _context * c)
+{
+    expression * old = * e;
+    * e = _expression (old, c);
+    expression_free (old);
+}
+
+void _replace_list (expression_list * list, const _context * c)
+{
+    for (; list != NULL; list = list->next)
+        _replace (& list->element, c);
+}
+
+instruction_list * _specialize (instruction_list * list, const _context * c)
+{
+    instruction_list ** node = & list;
+    while (* node != NULL)
+    {
+        instruction * instr = (* node)->element;
+
+        /* The finishes of the final program remember their phase. */
+        if (instr->annotation.date != NULL)
+            _replace (& instr->annotation.date, c);
+
+        switch (instr->type)
+        {
+            case INSTR_CALL:
+                _replace_list (instr->content.call.arguments, c);
+                for (access_list * a = instr->content.call.accesses; a != NULL;
+                        a = a->next)
+                    _replace_list (a->indices, c);
+                break;
+            case INSTR_FOR:
+            {
+                _replace (& instr->content.loop.left_boundary, c);
+                _replace (& instr->content.loop.right_boundary, c);
+
+                /* The iterator hides the parameter of the same name. */
+                ssize_t p = _find (c, instr->content.loop.identifier);
+                if (p >= 0)
+                    ++c->hidden[p];
+                instr->content.loop.body = _specialize (
+                        instr->content.loop.body, c);
+                if (p >= 0)
+                    --c->hidden[p];
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+            {
+                _replace (& instr->content.branch.condition, c);
+                instr->content.branch.true_body = _specialize (
+                        instr->content.branch.true_body, c);
+                if (instr->content.branch.has_else)
+                    instr->content.branch.false_body = _specialize (
+                            instr->content.branch.false_body, c);
+
+                if (! expression_is_boolean (instr->content.branch.condition))
+                    break;
+
+                /* The branch taken replaces the condition. */
+                instruction_list * taken = NULL;
+                if (expression_is_true (instr->content.branch.condition))
+                {
+                    taken = instr->content.branch.true_body;
+                    instr->content.branch.true_body = NULL;
+                }
+                else if (instr->content.branch.has_else)
+                {
+                    taken = instr->content.branch.false_body;
+                    instr->content.branch.false_body = NULL;
+                }
+
+                instruction_list * branch = * node;
+                instruction_list * rest = branch->next;
+                instruction_free (instr);
+                free (branch);
+
+                * node = instruction_list_cat (taken, rest);
+                while (* node != rest)
+                    node = & (* node)->next;
+                continue;
+            }
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instr->content.block = _specialize (instr->content.block, c);
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                _replace (& instr->content.bind.value, c);
+                break;
+            default:
+                break;
+        }
+
+        node = & (* node)->next;
+    }
+
+    return list;
+}
+
+instruction_list * _unroll (instruction_list * list, unsigned long int limit)
+{
+    instruction_list ** node = & list;
+    while (* node != NULL)
+    {
+        instruction * instr = (* node)->element;
+        const for_loop * loop = & instr->content.loop;
+
+        /* Only loops with constant boundaries have a known length. */
+        bool short_loop = instr->type == INSTR_FOR
+            && expression_is_number (loop->left_boundary)
+            && expression_is_number (loop->right_boundary);
+        long int first = 0;
+        long int last = -1;
+        if (short_loop)
+        {
+            first = expression_get_number (loop->left_boundary);
+            last = expression_get_number (loop->right_boundary);
+            short_loop = last >= first
+                && (unsigned long int) (last - first) < limit;
+        }
+
+        if (! short_loop)
+        {
+            switch (instr->type)
+            {
+                case INSTR_FOR:
+                    instr->content.loop.body = _unroll (
+                            instr->content.loop.body, limit);
+                    break;
+                case INSTR_IF:
+                case INSTR_IF_ELSE:
+                    instr->content.branch.true_body = _unroll (
+                            instr->content.branch.true_body, limit);
+                    if (instr->content.branch.has_else)
+                        instr->content.branch.false_body = _unroll (
+                                instr->content.branch.false_body, limit);
+                    break;
+                case INSTR_FINISH:
+                case INSTR_ASYNC:
+                case INSTR_CLOCKED_FINISH:
+                case INSTR_CLOCKED_ASYNC:
+                    instr->content.block = _unroll (instr->content.block,
+                            limit);
+                    break;
+                default:
+                    break;
+            }
+
+            node = & (* node)->next;
+            continue;
+        }
+
+        /* Each iteration is a copy of the body, specialized for the value
+         * of the iterator. The copies are visited next: their own loops may
+         * only now have constant boundaries.
+         */
+        string_list iterator;
+        string_list_init (& iterator);
+        string_list_append (& iterator, loop->identifier);
+        instruction_list * copies = NULL;
+        for (long int value = first; value <= last; ++value)
+        {
+            size_t hidden = 0;
+            _context c =
+            {
+                .names = & iterator,
+                .values = & value,
+                .hidden = & hidden,
+            };
+            copies = instruction_list_cat (copies,
+                    _specialize (instruction_list_copy (loop->body), & c));
+        }
+        string_list_clean (& iterator);
+
+        instruction_list * unrolled = * node;
+        * node = instruction_list_cat (copies, unrolled->next);
+        instruction_free (instr);
+        free (unrolled);
+    }
+
+    return list;
+}
@@ -81,7 +81,7 @@ size_t string_list_append (string_list * list, const char * parameter)
 // Getters.
 ////////////////////////////////////////////////////////////////////////////////
 
-ssize_t string_list_index (string_list * list, const char * parameter)
+ssize_t string_list_index (const string_list * list, const char * parameter)
 {
     ssize_t place = -1;
 
@@ -117,6 +117,7 @@ char * string_list_to_string (const string_list * list)
 {
     char * buffer = malloc (256);
     char * buffer_i = buffer;
+    buffer[0] = '\0';
     for (size_t i = 0; i < list->length; ++i)
     {
         sprintf (buffer_i, "%s%s", list->list[i],
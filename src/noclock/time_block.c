@@ -0,0 +1,183 @@
+/**
+ * \file time_block.c
+ * \brief Temporal blocking of clock phases.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "noclock/time_block.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Tile a loop whose body is the finish of a single phase.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop (modified).
+ * \param factor Number of phases per superstep.
+ */
+static void _block_loop (instruction * loop, unsigned long int factor);
+
+/**
+ * \brief Choose the number of phases per superstep of a loop.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop, whose body is the finish of a single phase.
+ * \param factor Number of phases per superstep.
+ * \param model What is known of the run.
+ * \return \p factor, or fewer phases when the profile says they are enough.
+ */
+static unsigned long int _factor (const instruction * loop,
+        unsigned long int factor, const cost_model * model);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_block_phases (instruction_list * list,
+        unsigned long int factor, const cost_model * model)
+{
+    if (factor == 1)
+        return;
+    if (factor == 0)
+        factor = TIME_BLOCK_AUTO;
+
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+            {
+                instruction_list * body = instr->content.loop.body;
+                if (body != NULL && body->next == NULL
+                    && body->element->type == INSTR_FINISH
+                    && body->element->annotation.date != NULL)
+                {
+                    /* Dependent phases stay apart. */
+                    unsigned long int f = _factor (instr, factor, model);
+                    unsigned long int superstep =
+                        body->element->annotation.superstep;
+                    if (f > superstep)
+                        f = superstep;
+                    if (f > 1)
+                        _block_loop (instr, f);
+                }
+                else
+                    instruction_list_block_phases (body, factor, model);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                instruction_list_block_phases (instr->content.branch.true_body,
+                        factor, model);
+                if (instr->content.branch.has_else)
+                    instruction_list_block_phases (
+                            instr->content.branch.false_body, factor, model);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instruction_list_block_phases (instr->content.block, factor,
+                        model);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _block_loop (instruction * loop, unsigned long int factor)
+{
+    expression * lo = loop->content.loop.left_boundary;
+    expression * hi = loop->content.loop.right_boundary;
+
+    /* A single superstep would already hold every phase. */
+    if (expression_is_number (lo) && expression_is_number (hi)
+        && expression_get_number (hi) - expression_get_number (lo) < 1)
+        return;
+
+    char * identifier = loop->content.loop.identifier;
+    char * block_identifier = malloc (strlen (identifier) + 7);
+    __forbid_value (block_identifier, NULL, "malloc", EX_OSERR);
+    sprintf (block_identifier, "%s_block", identifier);
+
+    expression * size = expression_from_number ((long int) factor);
+    expression * first = expression_add (expression_copy (lo),
+            expression_mult (expression_copy (size),
+                expression_from_identifier (block_identifier)));
+    expression * last = expression_min (expression_copy (hi),
+            expression_add (expression_copy (first),
+                expression_sub (size, expression_from_number (1))));
+
+    /* The finish now waits for all the phases of a superstep, so it no
+     * longer holds a single date.
+     */
+    instruction * finish = loop->content.loop.body->element;
+    instruction_list * phases = instruction_list_append (NULL,
+            instruction_for_loop (identifier, first, last,
+                finish->content.block));
+    finish->content.block = phases;
+    expression_free (finish->annotation.date);
+    finish->annotation.date = NULL;
+
+    /* The supersteps run over (0..floord (hi - lo, factor)): the division
+     * rounds towards negative infinity, so that there is no superstep at all
+     * when hi < lo.
+     */
+    loop->content.loop.identifier = block_identifier;
+    loop->content.loop.left_boundary = expression_from_number (0);
+    loop->content.loop.right_boundary = expression_div (
+            expression_sub (hi, lo),
+            expression_from_number ((long int) factor));
+}
+
+unsigned long int _factor (const instruction * loop, unsigned long int factor,
+        const cost_model * model)
+{
+    if (model == NULL || model->profile == NULL)
+        return factor;
+
+    /* The work of a single phase, its finish included. */
+    cost c;
+    instruction_list_cost (loop->content.loop.body, model, & c);
+    if (! cost_is_profiled (& c))
+        return factor;
+
+    unsigned long int grain = cost_grain (& c);
+    return grain < factor ? grain : factor;
+}
@@ -0,0 +1,467 @@
+/**
+ * \file unswitch.c
+ * \brief Loop unswitching.
+ * \author Harenome RAZANAJATO RANAIVOARIVONY
+ * \date 2015
+ * \copyright MIT License
+ * \since version `1.1.0`
+ */
+
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Harenome RAZANAJATO RANAIVOARIVONY
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "noclock/unswitch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Structs, ennums, typedefs, etc.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Identifiers bound by the loops between a loop and a branch.
+ * \since version `1.1.0`
+ */
+typedef struct _bound
+{
+    const char * identifier;        /**< The iterator of the loop. */
+    const struct _bound * up;       /**< The enclosing loops. */
+} _bound;
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions declarations.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Unswitch the loops of a list.
+ * \since version `1.1.0`
+ *
+ * \param list The list (modified).
+ * \param budget Remaining number of instructions to duplicate (modified).
+ */
+static void _unswitch_list (instruction_list * list, size_t * budget);
+
+/**
+ * \brief Unswitch a loop until it holds no invariant branch.
+ * \since version `1.1.0`
+ *
+ * \param loop The loop (modified).
+ * \param budget Remaining number of instructions to duplicate (modified).
+ * \return Either \p loop, or the branch replacing it.
+ */
+static instruction * _unswitch_loop (instruction * loop, size_t * budget);
+
+/**
+ * \brief Find the first branch whose condition does not depend on a loop.
+ * \since version `1.1.0`
+ *
+ * \param list The list.
+ * \param bound Identifiers bound by the loops.
+ * \return The link pointing to the node of the branch, or `NULL`.
+ */
+static instruction_list ** _find_guard (instruction_list ** list,
+        const _bound * bound);
+
+/**
+ * \brief Replace a branch with one of its bodies.
+ * \since version `1.1.0`
+ *
+ * \param link The link pointing to the node of the branch (modified).
+ * \param branch Which body to keep.
+ */
+static void _select (instruction_list ** link, bool branch);
+
+/**
+ * \brief Remove the blocks, loops and branches left empty.
+ * \since version `1.1.0`
+ *
+ * \param list The list (modified).
+ * \return The remaining instructions.
+ */
+static instruction_list * _prune (instruction_list * list);
+
+/**
+ * \brief Check whether an expression uses the identifiers bound by loops.
+ * \since version `1.1.0`
+ *
+ * \param e The expression.
+ * \param bound Identifiers bound by the loops.
+ * \retval true if \p e uses at least one of the identifiers.
+ * \retval false otherwise.
+ */
+static bool _depends (const expression * e, const _bound * bound);
+
+/**
+ * \brief Check whether a list does nothing.
+ * \since version `1.1.0`
+ *
+ * \param list The list.
+ * \retval true if \p list holds no call, advance or binding.
+ * \retval false otherwise.
+ */
+static bool _empty (const instruction_list * list);
+
+/**
+ * \brief Check whether a list binds identifiers.
+ * \since version `1.1.0`
+ *
+ * \param list The list.
+ * \retval true if \p list holds a val, var or assignment.
+ * \retval false otherwise.
+ */
+static bool _binds (const instruction_list * list);
+
+/**
+ * \brief Count the instructions of a list.
+ * \since version `1.1.0`
+ *
+ * \param list The list.
+ * \return The number of instructions, nested ones included.
+ */
+static size_t _size (const instruction_list * list);
+
+////////////////////////////////////////////////////////////////////////////////
+// Transformations.
+////////////////////////////////////////////////////////////////////////////////
+
+void instruction_list_unswitch (instruction_list * list, size_t budget)
+{
+    _unswitch_list (list, & budget);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static functions definitions.
+////////////////////////////////////////////////////////////////////////////////
+
+void _unswitch_list (instruction_list * list, size_t * budget)
+{
+    for (instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                /* The branches moved out of the inner loops may be invariant
+                 * in this one as well.
+                 */
+                _unswitch_list (instr->content.loop.body, budget);
+                current->element = _unswitch_loop (instr, budget);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                _unswitch_list (instr->content.branch.true_body, budget);
+                if (instr->content.branch.has_else)
+                    _unswitch_list (instr->content.branch.false_body, budget);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                _unswitch_list (instr->content.block, budget);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+instruction * _unswitch_loop (instruction * loop, size_t * budget)
+{
+    if (_binds (loop->content.loop.body))
+        return loop;
+
+    _bound bound = { loop->content.loop.identifier, NULL };
+    instruction_list ** link = _find_guard (& loop->content.loop.body,
+            & bound);
+    instruction_list single = { loop, NULL };
+    size_t size = _size (& single);
+    if (link == NULL || size > * budget)
+        return loop;
+    * budget -= size;
+
+    instruction * copy = instruction_copy (loop);
+    instruction_list ** copy_link = _find_guard (& copy->content.loop.body,
+            & bound);
+
+    expression * condition = expression_copy (
+            (* link)->element->content.branch.condition);
+    _select (link, true);
+    _select (copy_link, false);
+
+    instruction_list * true_body = _prune (
+            instruction_list_append (NULL, loop));
+    instruction_list * false_body = _prune (
+            instruction_list_append (NULL, copy));
+
+    /* Each version may still hold other invariant branches. */
+    if (true_body != NULL)
+        true_body->element = _unswitch_loop (true_body->element, budget);
+    if (false_body != NULL)
+        false_body->element = _unswitch_loop (false_body->element, budget);
+
+    if (true_body == NULL)
+    {
+        condition = expression_not (condition);
+        true_body = false_body;
+        false_body = NULL;
+    }
+
+    return instruction_if_then_else (false_body != NULL, condition,
+            true_body, false_body);
+}
+
+instruction_list ** _find_guard (instruction_list ** list,
+        const _bound * bound)
+{
+    for (instruction_list ** link = list; * link != NULL;
+            link = & (* link)->next)
+    {
+        instruction * instr = (* link)->element;
+        instruction_list ** found = NULL;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+            {
+                _bound inner = { instr->content.loop.identifier, bound };
+                found = _find_guard (& instr->content.loop.body, & inner);
+                break;
+            }
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                if (! _depends (instr->content.branch.condition, bound)
+                    && ! _empty (instr->content.branch.true_body))
+                    return link;
+                found = _find_guard (& instr->content.branch.true_body, bound);
+                if (found == NULL && instr->content.branch.has_else)
+                    found = _find_guard (& instr->content.branch.false_body,
+                            bound);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                found = _find_guard (& instr->content.block, bound);
+                break;
+            default:
+                break;
+        }
+
+        if (found != NULL)
+            return found;
+    }
+
+    return NULL;
+}
+
+void _select (instruction_list ** link, bool branch)
+{
+    instruction_list * node = * link;
+    if_then_else * b = & node->element->content.branch;
+
+    instruction_list * body = NULL;
+    if (branch)
+    {
+        body = b->true_body;
+        b->true_body = NULL;
+    }
+    else if (b->has_else)
+    {
+        body = b->false_body;
+        b->false_body = NULL;
+    }
+
+    * link = instruction_list_cat (body, node->next);
+    node->next = NULL;
+    instruction_list_free (node);
+}
+
+instruction_list * _prune (instruction_list * list)
+{
+    instruction_list * result = NULL;
+    instruction_list ** tail = & result;
+
+    while (list != NULL)
+    {
+        instruction_list * next = list->next;
+        list->next = NULL;
+
+        instruction * instr = list->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                instr->content.loop.body = _prune (instr->content.loop.body);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+            {
+                if_then_else * b = & instr->content.branch;
+                b->true_body = _prune (b->true_body);
+                if (b->has_else)
+                    b->false_body = _prune (b->false_body);
+                b->has_else = b->has_else && b->false_body != NULL;
+                if (b->true_body == NULL && b->has_else)
+                {
+                    b->condition = expression_not (b->condition);
+                    b->true_body = b->false_body;
+                    b->false_body = NULL;
+                    b->has_else = false;
+                }
+                break;
+            }
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                instr->content.block = _prune (instr->content.block);
+                break;
+            default:
+                break;
+        }
+
+        if (_empty (list))
+            instruction_list_free (list);
+        else
+        {
+            * tail = list;
+            tail = & list->next;
+        }
+
+        list = next;
+    }
+
+    return result;
+}
+
+bool _depends (const expression * e, const _bound * bound)
+{
+    for (const _bound * b = bound; b != NULL; b = b->up)
+        if (expression_uses (e, b->identifier))
+            return true;
+    return false;
+}
+
+bool _empty (const instruction_list * list)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                if (! _empty (instr->content.loop.body))
+                    return false;
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                if (! _empty (instr->content.branch.true_body)
+                    || (instr->content.branch.has_else
+                        && ! _empty (instr->content.branch.false_body)))
+                    return false;
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                if (! _empty (instr->content.block))
+                    return false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool _binds (const instruction_list * list)
+{
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                if (_binds (instr->content.loop.body))
+                    return true;
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                if (_binds (instr->content.branch.true_body)
+                    || (instr->content.branch.has_else
+                        && _binds (instr->content.branch.false_body)))
+                    return true;
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                if (_binds (instr->content.block))
+                    return true;
+                break;
+            case INSTR_VAL:
+            case INSTR_VAR:
+            case INSTR_ASSIGN:
+                return true;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+size_t _size (const instruction_list * list)
+{
+    size_t size = 0;
+    for (const instruction_list * current = list; current != NULL;
+            current = current->next)
+    {
+        const instruction * instr = current->element;
+        ++size;
+        switch (instr->type)
+        {
+            case INSTR_FOR:
+                size += _size (instr->content.loop.body);
+                break;
+            case INSTR_IF:
+            case INSTR_IF_ELSE:
+                size += _size (instr->content.branch.true_body);
+                if (instr->content.branch.has_else)
+                    size += _size (instr->content.branch.false_body);
+                break;
+            case INSTR_FINISH:
+            case INSTR_ASYNC:
+            case INSTR_CLOCKED_FINISH:
+            case INSTR_CLOCKED_ASYNC:
+                size += _size (instr->content.block);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return size;
+}
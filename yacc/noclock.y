@@ -39,22 +39,22 @@
 
     #include "noclock/expression.h"
     #include "noclock/expression_list.h"
+    #include "noclock/access_list.h"
     #include "noclock/instruction.h"
     #include "noclock/instruction_list.h"
     #include "noclock/instruction_to_set.h"
     #include "noclock/string_list.h"
 
     extern instruction_list * program;
-    extern isl_ctx * ctx;
-    extern isl_printer * printer;
     extern string_list * parameters;
 %}
 
 %token IMPORT PUBLIC CLASS STATIC DEF
 %token CLOCKED FINISH ASYNC ADVANCE
 %token IF ELSE FOR IN
+%token READS WRITES
 %token PLUS MINUS TIMES DIV LT GT EQ NE LE GE NOT AND OR
-%token MIN MAX
+%token MIN MAX FLOORD
 %token UNARY
 %token TRUE FALSE
 %token IDENTIFIER
@@ -70,7 +70,7 @@
 %left INCR DECR
 %left NOT
 %left UNARY
-%left MIN MAX
+%left MIN MAX FLOORD
 
 %union
 {
@@ -79,6 +79,7 @@
     instruction_list * _instruction_list;
     expression * _expression;
     expression_list * _expression_list;
+    access_list * _access_list;
     bool _boolean;
 }
 
@@ -88,6 +89,10 @@
 %type <_instruction_list> control_block
 %type <_expression> arith_expr
 %type <_expression_list> arith_expr_list
+%type <_expression_list> subscripts
+%type <_access_list> accesses
+%type <_access_list> access_items
+%type <_access_list> access
 %type <_expression> bool_expr
 %type <_identifier> IDENTIFIER
 %type <_number> NUMBER
@@ -108,10 +113,12 @@ string_list
     : IDENTIFIER
     {
         string_list_append (parameters, $1);
+        free ($1);
     }
     | IDENTIFIER ',' string_list
     {
         string_list_append (parameters, $1);
+        free ($1);
     }
 ;
 
@@ -215,7 +222,7 @@ instruction
         i->type = INSTR_ADVANCE;
         $$->element = i;
     }
-    | IDENTIFIER '(' arith_expr_list ')'
+    | IDENTIFIER '(' arith_expr_list ')' accesses
     {
         $$ = instruction_list_alloc ();
         instruction * i = instruction_alloc ();
@@ -223,6 +230,54 @@ instruction
         i->type = INSTR_CALL;
         i->content.call.identifier = $1;
         i->content.call.arguments = $3;
+        i->content.call.accesses = $5;
+    }
+;
+
+accesses
+    : READS access_items accesses
+    {
+        $$ = access_list_cat (access_list_set_write ($2, false), $3);
+    }
+    | WRITES access_items accesses
+    {
+        $$ = access_list_cat (access_list_set_write ($2, true), $3);
+    }
+    |
+    {
+        $$ = NULL;
+    }
+;
+
+access_items
+    : access
+    {
+        $$ = $1;
+    }
+    | access ',' access_items
+    {
+        $$ = access_list_cat ($1, $3);
+    }
+;
+
+access
+    : IDENTIFIER subscripts
+    {
+        $$ = access_list_alloc ($1, $2);
+    }
+;
+
+subscripts
+    : '[' arith_expr ']'
+    {
+        $$ = expression_list_alloc ();
+        $$->element = $2;
+    }
+    | '[' arith_expr ']' subscripts
+    {
+        $$ = expression_list_alloc ();
+        $$->element = $2;
+        $$ = expression_list_cat ($$, $4);
     }
 ;
 
@@ -328,6 +383,10 @@ arith_expr
     {
         $$ = expression_max ($3, $5);
     }
+    | FLOORD '(' arith_expr ',' arith_expr ')'
+    {
+        $$ = expression_div ($3, $5);
+    }
     | '(' arith_expr ')'
     {
         $$ = $2;